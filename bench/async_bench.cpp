@@ -9,6 +9,7 @@
 #include "spdlog/spdlog.h"
 #include "spdlog/async.h"
 #include "spdlog/sinks/basic_file_sink.h"
+#include "spdlog/sinks/null_sink.h"
 
 #ifdef SPDLOG_FMT_EXTERNAL
 #    include <fmt/format.h>
@@ -30,6 +31,9 @@ using namespace spdlog::sinks;
 using namespace utils;
 
 void bench_mt(int howmany, std::shared_ptr<spdlog::logger> log, int thread_count);
+void bench_scaling(int howmany, int queue_size);
+void bench_sharded(int howmany, int queue_size);
+void thread_fun(std::shared_ptr<spdlog::logger> logger, int howmany);
 
 #ifdef _MSC_VER
 #    pragma warning(push)
@@ -81,6 +85,20 @@ int main(int argc, char *argv[])
         if (argc == 1)
         {
             spdlog::info("Usage: {} <message_count> <threads> <q_size> <iterations>", argv[0]);
+            spdlog::info("       {} scaling [message_count] [q_size]", argv[0]);
+            spdlog::info("       {} sharded [message_count] [q_size]", argv[0]);
+            return 0;
+        }
+
+        if (std::string(argv[1]) == "scaling")
+        {
+            bench_scaling(argc > 2 ? atoi(argv[2]) : howmany, argc > 3 ? atoi(argv[3]) : queue_size);
+            return 0;
+        }
+
+        if (std::string(argv[1]) == "sharded")
+        {
+            bench_sharded(argc > 2 ? atoi(argv[2]) : howmany, argc > 3 ? atoi(argv[3]) : queue_size);
             return 0;
         }
 
@@ -149,6 +167,75 @@ int main(int argc, char *argv[])
     return 0;
 }
 
+// throughput of the blocking and lock-free queues with 1 to 64 producer threads.
+// uses a null sink so that the queue is the bottleneck.
+void bench_scaling(int howmany, int queue_size)
+{
+    spdlog::info("-------------------------------------------------");
+    spdlog::info("Messages     : {:L}", howmany);
+    spdlog::info("Queue        : {:L} slots", queue_size);
+    spdlog::info("-------------------------------------------------");
+
+    for (auto queue_type : {async_queue_type::blocking, async_queue_type::lockfree})
+    {
+        spdlog::info("");
+        spdlog::info("*********************************");
+        spdlog::info("Queue: {}", queue_type == async_queue_type::blocking ? "blocking" : "lockfree");
+        spdlog::info("*********************************");
+        for (int threads = 1; threads <= 64; threads *= 2)
+        {
+            spdlog::info("Producers: {}", threads);
+            auto tp = std::make_shared<details::thread_pool>(queue_size, 1, queue_type);
+            auto logger = std::make_shared<async_logger>(
+                "async_logger", std::make_shared<null_sink_mt>(), std::move(tp), async_overflow_policy::block);
+            bench_mt(howmany, std::move(logger), threads);
+        }
+    }
+    spdlog::shutdown();
+}
+
+// throughput of the shared and sharded thread pools with 1 to 16 worker threads.
+// 16 producers log to their own logger, each writing to its own file.
+void bench_sharded(int howmany, int queue_size)
+{
+    const int loggers_n = 16;
+    spdlog::info("-------------------------------------------------");
+    spdlog::info("Messages     : {:L}", howmany);
+    spdlog::info("Queue        : {:L} slots", queue_size);
+    spdlog::info("Loggers      : {}", loggers_n);
+    spdlog::info("-------------------------------------------------");
+
+    for (auto pool_mode : {async_pool_mode::shared, async_pool_mode::sharded})
+    {
+        spdlog::info("");
+        spdlog::info("*********************************");
+        spdlog::info("Pool: {}", pool_mode == async_pool_mode::shared ? "shared" : "sharded");
+        spdlog::info("*********************************");
+        for (size_t workers = 1; workers <= 16; workers *= 2)
+        {
+            spdlog::info("Workers: {}", workers);
+            auto start = high_resolution_clock::now();
+            {
+                auto tp = std::make_shared<details::thread_pool>(queue_size, workers, async_queue_type::blocking, pool_mode);
+                vector<thread> threads;
+                for (int i = 0; i < loggers_n; i++)
+                {
+                    auto file_sink = std::make_shared<basic_file_sink_mt>(fmt::format("logs/sharded_async_{}.log", i), true);
+                    auto logger = std::make_shared<async_logger>("async_logger", std::move(file_sink), tp, async_overflow_policy::block);
+                    threads.push_back(std::thread(thread_fun, std::move(logger), howmany / loggers_n));
+                }
+                for (auto &t : threads)
+                {
+                    t.join();
+                }
+            } // wait for the workers to write every message
+            auto delta_d = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+            spdlog::info("Elapsed: {} secs\t {:L}/sec", delta_d, int(howmany / delta_d));
+        }
+    }
+    spdlog::shutdown();
+}
+
 void thread_fun(std::shared_ptr<spdlog::logger> logger, int howmany)
 {
     for (int i = 0; i < howmany; i++)
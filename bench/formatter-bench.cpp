@@ -7,6 +7,10 @@
 
 #include "spdlog/spdlog.h"
 #include "spdlog/pattern_formatter.h"
+#include "spdlog/json_formatter.h"
+#include "spdlog/binary_formatter.h"
+
+#include <unordered_set>
 
 void bench_formatter(benchmark::State &state, std::string pattern)
 {
@@ -26,6 +30,343 @@ void bench_formatter(benchmark::State &state, std::string pattern)
     }
 }
 
+#ifdef SPDLOG_JSON_LOGGER
+void bench_json_formatter(benchmark::State &state, spdlog::json_serializer serializer, spdlog::json_encoding encoding, bool with_params)
+{
+    auto formatter = spdlog::details::make_unique<spdlog::json_formatter>(spdlog::details::os::default_eol, serializer, encoding);
+    spdlog::memory_buf_t dest;
+    std::string logger_name = "logger-name";
+    const char *text = "Hello. This is some message with length of 80                                   ";
+
+    spdlog::source_loc source_loc{"a/b/c/d/myfile.cpp", 123, "some_func()"};
+    spdlog::details::log_msg msg(source_loc, logger_name, spdlog::level::info, text);
+    nlohmann::json params = {{"user_id", 42}, {"latency_us", 3.2}, {"path", "/index.html"}, {"ok", true}};
+    if (with_params)
+    {
+        msg.params = &params;
+    }
+
+    for (auto _ : state)
+    {
+        dest.clear();
+        formatter->format(msg, dest);
+        benchmark::DoNotOptimize(dest);
+    }
+    state.counters["bytes"] = static_cast<double>(dest.size());
+}
+
+void bench_binary_formatter(benchmark::State &state, bool with_params)
+{
+    spdlog::binary_formatter formatter;
+    spdlog::memory_buf_t dest;
+    std::string logger_name = "logger-name";
+    const char *text = "Hello. This is some message with length of 80                                   ";
+
+    spdlog::source_loc source_loc{"a/b/c/d/myfile.cpp", 123, "some_func()"};
+    spdlog::details::log_msg msg(source_loc, logger_name, spdlog::level::info, text);
+    nlohmann::json params = {{"user_id", 42}, {"latency_us", 3.2}, {"path", "/index.html"}, {"ok", true}};
+    if (with_params)
+    {
+        msg.params = &params;
+    }
+
+    for (auto _ : state)
+    {
+        dest.clear();
+        formatter.format(msg, dest);
+        benchmark::DoNotOptimize(dest);
+    }
+    state.counters["bytes"] = static_cast<double>(dest.size());
+}
+
+// writes a single field with a key that is escaped on every write
+class plain_key_populator : public spdlog::populators::populator
+{
+public:
+    explicit plain_key_populator(std::string key)
+        : key_(std::move(key))
+    {}
+
+    void populate(const spdlog::details::log_msg &msg, nlohmann::json &dest) override
+    {
+        dest[key_] = msg.thread_id;
+    }
+
+    void write(const spdlog::details::log_msg &msg, spdlog::json_writer &dest) override
+    {
+        dest.field(key_, msg.thread_id);
+    }
+
+    std::unique_ptr<populator> clone() const override
+    {
+        return spdlog::details::make_unique<plain_key_populator>(key_);
+    }
+
+private:
+    std::string key_;
+};
+
+// same as plain_key_populator, but with a pre-rendered key
+class rendered_key_populator : public spdlog::populators::populator
+{
+public:
+    explicit rendered_key_populator(const std::string &key)
+        : key_(key)
+    {}
+
+    void populate(const spdlog::details::log_msg &msg, nlohmann::json &dest) override
+    {
+        dest[key_.name()] = msg.thread_id;
+    }
+
+    void write(const spdlog::details::log_msg &msg, spdlog::json_writer &dest) override
+    {
+        dest.field(key_, msg.thread_id);
+    }
+
+    std::unique_ptr<populator> clone() const override
+    {
+        return spdlog::details::make_unique<rendered_key_populator>(key_.name());
+    }
+
+private:
+    spdlog::json_key key_;
+};
+
+// the populators as they used to be stored: hashed set, keys escaped per message
+void bench_json_populators_unordered(benchmark::State &state, int n_populators)
+{
+    std::unordered_set<std::unique_ptr<spdlog::populators::populator>> populators;
+    for (int i = 0; i < n_populators; i++)
+    {
+        populators.insert(spdlog::details::make_unique<plain_key_populator>(fmt::format("field_{}", i)));
+    }
+    spdlog::json_writer writer;
+    spdlog::memory_buf_t dest;
+    spdlog::details::log_msg msg("logger-name", spdlog::level::info, "message");
+
+    for (auto _ : state)
+    {
+        dest.clear();
+        writer.begin_object(dest);
+        for (const auto &populator : populators)
+        {
+            populator->write(msg, writer);
+        }
+        writer.end_object();
+        benchmark::DoNotOptimize(dest);
+    }
+}
+
+void bench_json_populators_ordered(benchmark::State &state, int n_populators)
+{
+    spdlog::populators::populator_set populators;
+    for (int i = 0; i < n_populators; i++)
+    {
+        populators.insert(spdlog::details::make_unique<rendered_key_populator>(fmt::format("field_{}", i)));
+    }
+    spdlog::json_writer writer;
+    spdlog::memory_buf_t dest;
+    spdlog::details::log_msg msg("logger-name", spdlog::level::info, "message");
+
+    for (auto _ : state)
+    {
+        dest.clear();
+        writer.begin_object(dest);
+        for (const auto &populator : populators)
+        {
+            populator->write(msg, writer);
+        }
+        writer.end_object();
+        benchmark::DoNotOptimize(dest);
+    }
+}
+
+// a built-in populator left out of json_formatter's plan: called through its virtual write()
+template<typename Populator>
+class unplanned_populator : public Populator
+{
+public:
+    spdlog::populators::field_plan plan() const override
+    {
+        return spdlog::populators::field_plan();
+    }
+};
+
+// n built-in populators, cycling through the cheap kinds
+template<template<typename> class Wrap>
+spdlog::populators::populator_set make_builtin_populators(int n_populators)
+{
+    spdlog::populators::populator_set populators;
+    for (int i = 0; i < n_populators; i++)
+    {
+        switch (i % 5)
+        {
+        case 0:
+            populators.insert(spdlog::details::make_unique<Wrap<spdlog::populators::level_populator>>());
+            break;
+        case 1:
+            populators.insert(spdlog::details::make_unique<Wrap<spdlog::populators::message_populator>>());
+            break;
+        case 2:
+            populators.insert(spdlog::details::make_unique<Wrap<spdlog::populators::logger_name_populator>>());
+            break;
+        case 3:
+            populators.insert(spdlog::details::make_unique<Wrap<spdlog::populators::thread_id_populator>>());
+            break;
+        default:
+            populators.insert(spdlog::details::make_unique<Wrap<spdlog::populators::timestamp_populator>>());
+            break;
+        }
+    }
+    return populators;
+}
+
+template<typename Populator>
+using planned_populator = Populator;
+
+void bench_json_builtins(benchmark::State &state, spdlog::populators::populator_set &&populators)
+{
+    spdlog::json_formatter formatter(std::move(populators));
+    spdlog::memory_buf_t dest;
+    spdlog::details::log_msg msg("logger-name", spdlog::level::info, "message");
+
+    for (auto _ : state)
+    {
+        dest.clear();
+        formatter.format(msg, dest);
+        benchmark::DoNotOptimize(dest);
+    }
+}
+
+// one virtual write() per field
+void bench_json_builtins_virtual(benchmark::State &state, int n_populators)
+{
+    bench_json_builtins(state, make_builtin_populators<unplanned_populator>(n_populators));
+}
+
+// the fields written by json_formatter's compiled plan
+void bench_json_builtins_plan(benchmark::State &state, int n_populators)
+{
+    bench_json_builtins(state, make_builtin_populators<planned_populator>(n_populators));
+}
+
+void bench_json_date_time(benchmark::State &state, std::shared_ptr<spdlog::populators::populator> populator)
+{
+    spdlog::json_writer writer;
+    spdlog::memory_buf_t dest;
+    spdlog::details::log_msg msg("logger-name", spdlog::level::info, "message");
+
+    for (auto _ : state)
+    {
+        dest.clear();
+        writer.begin_object(dest);
+        populator->write(msg, writer);
+        writer.end_object();
+        benchmark::DoNotOptimize(dest);
+    }
+}
+
+// typed fields with plain or interned keys
+void bench_json_typed_fields(benchmark::State &state, bool interned)
+{
+    spdlog::json_formatter formatter;
+    spdlog::memory_buf_t dest;
+    spdlog::details::log_msg_buffer msg(spdlog::details::log_msg("logger-name", spdlog::level::info, "Hello"));
+    if (interned)
+    {
+        msg.add_field(spdlog::field_key("user_id"), int64_t{42});
+        msg.add_field(spdlog::field_key("latency_us"), 3.2);
+        msg.add_field(spdlog::field_key("path"), spdlog::string_view_t("/index.html"));
+        msg.add_field(spdlog::field_key("ok"), true);
+    }
+    else
+    {
+        msg.add_field("user_id", int64_t{42});
+        msg.add_field("latency_us", 3.2);
+        msg.add_field("path", spdlog::string_view_t("/index.html"));
+        msg.add_field("ok", true);
+    }
+
+    for (auto _ : state)
+    {
+        dest.clear();
+        formatter.format(msg, dest);
+        benchmark::DoNotOptimize(dest);
+    }
+}
+
+// escaping of a clean ASCII string of the given size
+void bench_json_escape(benchmark::State &state, size_t size)
+{
+    const std::string text(size, 'x');
+    spdlog::memory_buf_t dest;
+    for (auto _ : state)
+    {
+        dest.clear();
+        spdlog::json_writer::write_string(text, dest);
+        benchmark::DoNotOptimize(dest);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size));
+}
+
+// same, through nlohmann's byte by byte serializer
+void bench_json_escape_nlohmann(benchmark::State &state, size_t size)
+{
+    const nlohmann::json text = std::string(size, 'x');
+    std::string dest;
+    for (auto _ : state)
+    {
+        dest = text.dump();
+        benchmark::DoNotOptimize(dest);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size));
+}
+
+void bench_json_formatters()
+{
+    using spdlog::json_encoding;
+    using spdlog::json_serializer;
+    benchmark::RegisterBenchmark("json/dom", &bench_json_formatter, json_serializer::dom, json_encoding::text, false);
+    benchmark::RegisterBenchmark("json/stream", &bench_json_formatter, json_serializer::stream, json_encoding::text, false);
+    benchmark::RegisterBenchmark("json/dom/params", &bench_json_formatter, json_serializer::dom, json_encoding::text, true);
+    benchmark::RegisterBenchmark("json/stream/params", &bench_json_formatter, json_serializer::stream, json_encoding::text, true);
+    benchmark::RegisterBenchmark("json/stream/msgpack", &bench_json_formatter, json_serializer::stream, json_encoding::msgpack, false);
+    benchmark::RegisterBenchmark("json/stream/msgpack/params", &bench_json_formatter, json_serializer::stream, json_encoding::msgpack, true);
+    benchmark::RegisterBenchmark("json/stream/cbor", &bench_json_formatter, json_serializer::stream, json_encoding::cbor, false);
+    benchmark::RegisterBenchmark("json/stream/cbor/params", &bench_json_formatter, json_serializer::stream, json_encoding::cbor, true);
+    benchmark::RegisterBenchmark("json/dom/msgpack/params", &bench_json_formatter, json_serializer::dom, json_encoding::msgpack, true);
+    benchmark::RegisterBenchmark("binary", &bench_binary_formatter, false);
+    benchmark::RegisterBenchmark("binary/params", &bench_binary_formatter, true);
+
+    using std::make_shared;
+    benchmark::RegisterBenchmark("json/date_time/pattern", &bench_json_date_time,
+        make_shared<spdlog::populators::pattern_populator>("date_time", "%Y-%m-%d %H:%M:%S.%e%z"));
+    benchmark::RegisterBenchmark("json/date_time/cached", &bench_json_date_time, make_shared<spdlog::populators::date_time_populator>());
+    benchmark::RegisterBenchmark("json/date_time/rfc3339_nanos", &bench_json_date_time,
+        make_shared<spdlog::populators::date_time_populator>(spdlog::timestamp_format::rfc3339_nanos));
+    benchmark::RegisterBenchmark("json/date_time/epoch_micros", &bench_json_date_time,
+        make_shared<spdlog::populators::date_time_populator>(spdlog::timestamp_format::epoch_micros));
+
+    benchmark::RegisterBenchmark("json/typed_fields", &bench_json_typed_fields, false);
+    benchmark::RegisterBenchmark("json/typed_fields/interned", &bench_json_typed_fields, true);
+
+    for (size_t size : {16, 64, 256, 1024, 4096})
+    {
+        benchmark::RegisterBenchmark(fmt::format("json/escape/{}", size).c_str(), &bench_json_escape, size);
+        benchmark::RegisterBenchmark(fmt::format("json/escape/nlohmann/{}", size).c_str(), &bench_json_escape_nlohmann, size);
+    }
+
+    for (int n : {4, 8, 16})
+    {
+        benchmark::RegisterBenchmark(fmt::format("json/populators/unordered/{}", n).c_str(), &bench_json_populators_unordered, n);
+        benchmark::RegisterBenchmark(fmt::format("json/populators/ordered/{}", n).c_str(), &bench_json_populators_ordered, n);
+        benchmark::RegisterBenchmark(fmt::format("json/builtins/virtual/{}", n).c_str(), &bench_json_builtins_virtual, n);
+        benchmark::RegisterBenchmark(fmt::format("json/builtins/plan/{}", n).c_str(), &bench_json_builtins_plan, n);
+    }
+}
+#endif
+
 void bench_formatters()
 {
     // basic patterns(single flag)
@@ -62,7 +403,7 @@ int main(int argc, char *argv[])
     spdlog::set_pattern("[%^%l%$] %v");
     if (argc != 2)
     {
-        spdlog::error("Usage: {} <pattern> (or \"all\" to bench all)", argv[0]);
+        spdlog::error("Usage: {} <pattern> (or \"all\" to bench all, \"json\" to bench the json formatter)", argv[0]);
         exit(1);
     }
 
@@ -70,7 +411,16 @@ int main(int argc, char *argv[])
     if (pattern == "all")
     {
         bench_formatters();
+#ifdef SPDLOG_JSON_LOGGER
+        bench_json_formatters();
+#endif
+    }
+#ifdef SPDLOG_JSON_LOGGER
+    else if (pattern == "json")
+    {
+        bench_json_formatters();
     }
+#endif
     else
     {
         benchmark::RegisterBenchmark(pattern.c_str(), &bench_formatter, pattern);
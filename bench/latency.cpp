@@ -15,6 +15,14 @@
 #include "spdlog/sinks/daily_file_sink.h"
 #include "spdlog/sinks/null_sink.h"
 #include "spdlog/sinks/rotating_file_sink.h"
+#ifndef _WIN32
+#    include "spdlog/sinks/mmap_file_sink.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
 
 void bench_c_string(benchmark::State &state, std::shared_ptr<spdlog::logger> logger)
 {
@@ -49,6 +57,45 @@ void bench_logger_fmt_string(benchmark::State &state, std::shared_ptr<spdlog::lo
     }
 }
 
+// a formatted message of about state.range(0) bytes
+void bench_formatted_payload(benchmark::State &state, std::shared_ptr<spdlog::logger> logger)
+{
+    const std::string text(static_cast<size_t>(state.range(0)) - 14, 'x');
+    int i = 0;
+    for (auto _ : state)
+    {
+        logger->info("{} msg #{:>8}", text, ++i);
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+// enqueue latency percentiles, from timing each log call.
+void bench_enqueue_latency(benchmark::State &state, std::shared_ptr<spdlog::logger> logger)
+{
+    using std::chrono::steady_clock;
+    std::vector<int64_t> samples;
+    int i = 0;
+    for (auto _ : state)
+    {
+        auto start = steady_clock::now();
+        logger->info("Hello logger: msg number {}...............", ++i);
+        samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(steady_clock::now() - start).count());
+    }
+    if (samples.empty())
+    {
+        return;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p) {
+        return static_cast<double>(samples[std::min(samples.size() - 1, static_cast<size_t>(p * static_cast<double>(samples.size())))]);
+    };
+    state.counters["p50_ns"] = percentile(0.5);
+    state.counters["p99_ns"] = percentile(0.99);
+    state.counters["p999_ns"] = percentile(0.999);
+    state.counters["p9999_ns"] = percentile(0.9999);
+    state.counters["max_ns"] = static_cast<double>(samples.back());
+}
+
 void bench_disabled_macro(benchmark::State &state, std::shared_ptr<spdlog::logger> logger)
 {
     int i = 0;
@@ -61,6 +108,59 @@ void bench_disabled_macro(benchmark::State &state, std::shared_ptr<spdlog::logge
     }
 }
 
+#ifdef SPDLOG_JSON_LOGGER
+void bench_json_params(benchmark::State &state, std::shared_ptr<spdlog::logger> logger)
+{
+    int i = 0;
+    for (auto _ : state)
+    {
+        logger->info("Hello logger")({{"user_id", ++i}, {"latency_us", 3.2}});
+    }
+    state.counters["executor_bytes"] = sizeof(spdlog::details::executor);
+}
+
+void bench_disabled_params(benchmark::State &state, std::shared_ptr<spdlog::logger> logger)
+{
+    int i = 0;
+    for (auto _ : state)
+    {
+        logger->debug("Hello logger: msg number {}...............", i)({{"user_id", ++i}, {"path", "/index.html"}, {"latency_us", 3.2}});
+    }
+}
+
+void bench_disabled_lazy_params(benchmark::State &state, std::shared_ptr<spdlog::logger> logger)
+{
+    int i = 0;
+    for (auto _ : state)
+    {
+        logger->debug("Hello logger: msg number {}...............", i)(
+            SPDLOG_LAZY_PARAMS({{"user_id", ++i}, {"path", "/index.html"}, {"latency_us", 3.2}}));
+    }
+}
+
+void bench_disabled_lazy_macro(benchmark::State &state, std::shared_ptr<spdlog::logger> logger)
+{
+    int i = 0;
+    benchmark::DoNotOptimize(i);      // prevent unused warnings
+    benchmark::DoNotOptimize(logger); // prevent unused warnings
+    for (auto _ : state)
+    {
+        SPDLOG_LOGGER_DEBUG(logger, "Hello logger: msg number {}...............", i)(SPDLOG_LAZY_PARAMS({{"user_id", ++i}}));
+        SPDLOG_DEBUG("Hello logger: msg number {}...............", i)(SPDLOG_LAZY_PARAMS({{"user_id", ++i}}));
+    }
+}
+
+void bench_typed_fields(benchmark::State &state, std::shared_ptr<spdlog::logger> logger)
+{
+    int i = 0;
+    for (auto _ : state)
+    {
+        logger->info("Hello logger").field("user_id", ++i).field("latency_us", 3.2);
+    }
+    state.counters["executor_bytes"] = sizeof(spdlog::details::executor);
+}
+#endif
+
 #ifdef __linux__
 void bench_dev_null()
 {
@@ -94,16 +194,29 @@ int main(int argc, char *argv[])
     auto tracing_disabled_logger = std::make_shared<spdlog::logger>("bench", std::make_shared<null_sink_mt>());
     tracing_disabled_logger->enable_backtrace(64);
     benchmark::RegisterBenchmark("disabled-at-runtime/backtrace", bench_logger, tracing_disabled_logger);
+#ifdef SPDLOG_JSON_LOGGER
+    // disabled structured calls
+    benchmark::RegisterBenchmark("disabled-at-compile-time/lazy_params", bench_disabled_lazy_macro, disabled_logger);
+    benchmark::RegisterBenchmark("disabled-at-runtime/params", bench_disabled_params, disabled_logger);
+    benchmark::RegisterBenchmark("disabled-at-runtime/lazy_params", bench_disabled_lazy_params, disabled_logger);
+#endif
 
     auto null_logger_st = std::make_shared<spdlog::logger>("bench", std::make_shared<null_sink_st>());
     benchmark::RegisterBenchmark("null_sink_st (500_bytes c_str)", bench_c_string, std::move(null_logger_st));
     benchmark::RegisterBenchmark("null_sink_st", bench_logger, null_logger_st);
     benchmark::RegisterBenchmark("null_sink_fmt_string", bench_logger_fmt_string, null_logger_st);
+    benchmark::RegisterBenchmark("null_sink_st/formatted_payload", bench_formatted_payload, null_logger_st)->Arg(100)->Arg(1024);
     // with backtrace of 64
     auto tracing_null_logger_st = std::make_shared<spdlog::logger>("bench", std::make_shared<null_sink_st>());
     tracing_null_logger_st->enable_backtrace(64);
     benchmark::RegisterBenchmark("null_sink_st/backtrace", bench_logger, tracing_null_logger_st);
 
+#ifdef SPDLOG_JSON_LOGGER
+    // structured fields: nlohmann::json params vs typed fields
+    benchmark::RegisterBenchmark("null_sink_st/json_params", bench_json_params, null_logger_st);
+    benchmark::RegisterBenchmark("null_sink_st/typed_fields", bench_typed_fields, null_logger_st);
+#endif
+
 #ifdef __linux
     bench_dev_null();
 #endif // __linux__
@@ -120,6 +233,28 @@ int main(int argc, char *argv[])
         benchmark::RegisterBenchmark("basic_st/backtrace", bench_logger, std::move(tracing_basic_st))->UseRealTime();
         spdlog::drop("tracing_basic_st");
 
+#ifndef _WIN32
+        // basic_st with the fd and io_uring backends
+        for (auto backend : {spdlog::file_backend::fd, spdlog::file_backend::io_uring})
+        {
+            spdlog::file_options options;
+            options.backend = backend;
+            bool fd = backend == spdlog::file_backend::fd;
+            auto logger = spdlog::basic_logger_st(fd ? "basic_st_fd" : "basic_st_io_uring",
+                fd ? "latency_logs/basic_st_fd.log" : "latency_logs/basic_st_io_uring.log", true, options);
+            benchmark::RegisterBenchmark(fd ? "basic_st/backend:fd" : "basic_st/backend:io_uring", bench_logger, std::move(logger))
+                ->UseRealTime();
+            spdlog::drop(fd ? "basic_st_fd" : "basic_st_io_uring");
+        }
+
+        // mmap st
+        spdlog::sinks::mmap_file_sink_config mmap_config("latency_logs/mmap_st.log");
+        mmap_config.truncate = true;
+        auto mmap_st = spdlog::mmap_logger_st("mmap_st", mmap_config);
+        benchmark::RegisterBenchmark("mmap_st", bench_logger, std::move(mmap_st))->UseRealTime();
+        spdlog::drop("mmap_st");
+#endif
+
         // rotating st
         auto rotating_st = spdlog::rotating_logger_st("rotating_st", "latency_logs/rotating_st.log", file_size, rotating_files);
         benchmark::RegisterBenchmark("rotating_st", bench_logger, std::move(rotating_st))->UseRealTime();
@@ -130,6 +265,18 @@ int main(int argc, char *argv[])
         benchmark::RegisterBenchmark("rotating_st/backtrace", bench_logger, std::move(tracing_rotating_st))->UseRealTime();
         spdlog::drop("tracing_rotating_st");
 
+        // latency across rotations: a small max size rotates every ~2000 messages
+        for (auto mode : {spdlog::sinks::rotation_mode::blocking, spdlog::sinks::rotation_mode::background})
+        {
+            const bool background = mode == spdlog::sinks::rotation_mode::background;
+            auto rotation_logger = spdlog::rotating_logger_st(background ? "rotation_background" : "rotation_blocking",
+                background ? "latency_logs/rotation_background.log" : "latency_logs/rotation_blocking.log", 256 * 1024, 20, false, mode);
+            benchmark::RegisterBenchmark(background ? "rotating_st/rotation:background" : "rotating_st/rotation:blocking", bench_enqueue_latency,
+                rotation_logger)
+                ->UseRealTime();
+            spdlog::drop(rotation_logger->name());
+        }
+
         // daily st
         auto daily_st = spdlog::daily_logger_mt("daily_st", "latency_logs/daily_st.log");
         benchmark::RegisterBenchmark("daily_st", bench_logger, std::move(daily_st))->UseRealTime();
@@ -172,6 +319,42 @@ int main(int argc, char *argv[])
     async_logger_tracing->enable_backtrace(32);
     benchmark::RegisterBenchmark("async_logger/tracing", bench_logger, async_logger_tracing)->Threads(n_threads)->UseRealTime();
 
+    // enqueue latency of the thread pool wait strategies
+    std::vector<std::shared_ptr<spdlog::details::thread_pool>> strategy_tps;
+    for (auto strategy : {spdlog::async_wait_strategy::block, spdlog::async_wait_strategy::spin_yield, spdlog::async_wait_strategy::busy_spin})
+    {
+        const char *strategy_name = strategy == spdlog::async_wait_strategy::block        ? "block"
+                                    : strategy == spdlog::async_wait_strategy::spin_yield ? "spin_yield"
+                                                                                          : "busy_spin";
+        strategy_tps.push_back(
+            std::make_shared<spdlog::details::thread_pool>(8192, 1, spdlog::async_queue_type::blocking, spdlog::async_pool_mode::shared, strategy));
+        auto strategy_logger = std::make_shared<spdlog::async_logger>(
+            "async_logger", std::make_shared<null_sink_mt>(), strategy_tps.back(), spdlog::async_overflow_policy::overrun_oldest);
+        benchmark::RegisterBenchmark((std::string("async_logger/wait_strategy:") + strategy_name).c_str(), bench_enqueue_latency,
+            std::move(strategy_logger))
+            ->UseRealTime();
+    }
+
+    // enqueue latency of a small queue under backpressure, blocking or dropping low levels
+    for (auto policy : {spdlog::async_overflow_policy::block, spdlog::async_overflow_policy::drop_by_level})
+    {
+        strategy_tps.push_back(std::make_shared<spdlog::details::thread_pool>(1024, 1));
+        auto policy_logger = std::make_shared<spdlog::async_logger>(
+            "async_logger", std::make_shared<spdlog::sinks::basic_file_sink_mt>("latency_logs/overflow_policy.log", true), strategy_tps.back(), policy);
+        benchmark::RegisterBenchmark(policy == spdlog::async_overflow_policy::block ? "async_logger/overflow:block" : "async_logger/overflow:drop_by_level",
+            bench_enqueue_latency, std::move(policy_logger))
+            ->UseRealTime();
+    }
+
+#ifdef SPDLOG_JSON_LOGGER
+    // producer side cost of structured fields
+    auto json_tp = std::make_shared<spdlog::details::thread_pool>(queue_size, 1);
+    auto async_json_logger = std::make_shared<spdlog::async_logger>(
+        "async_json_logger", std::make_shared<null_sink_mt>(), json_tp, spdlog::async_overflow_policy::overrun_oldest);
+    benchmark::RegisterBenchmark("async_logger/json_params", bench_json_params, async_json_logger)->UseRealTime();
+    benchmark::RegisterBenchmark("async_logger/typed_fields", bench_typed_fields, async_json_logger)->UseRealTime();
+#endif
+
     benchmark::Initialize(&argc, argv);
     benchmark::RunSpecifiedBenchmarks();
 }
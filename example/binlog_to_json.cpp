@@ -0,0 +1,84 @@
+//
+// Copyright(c) 2015 Gabi Melman.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+// Render files written with spdlog::binary_formatter as the NDJSON the default
+// json_formatter would have written. Files are decoded in the given order, as a
+// single stream, so that rotated files can be decoded along with the file that
+// introduced their logger names:
+//
+//   binlog_to_json logs/app.2.bin logs/app.1.bin logs/app.bin > app.json
+//
+// date_time is rendered in the local time zone of the machine running the tool.
+
+#include "spdlog/spdlog.h"
+
+#ifdef SPDLOG_JSON_LOGGER
+
+#include "spdlog/binary_formatter.h"
+#include "spdlog/json_formatter.h"
+
+#include <cstdio>
+#include <exception>
+#include <string>
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::fprintf(stderr, "usage: %s FILE...\n", argv[0]);
+        return 1;
+    }
+
+    spdlog::binary_decoder decoder;
+    spdlog::json_formatter formatter;
+    spdlog::memory_buf_t out;
+    std::string pending;
+    char chunk[64 * 1024];
+
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::FILE *in = std::fopen(argv[i], "rb");
+            if (in == nullptr)
+            {
+                std::fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[i]);
+                return 1;
+            }
+            size_t n;
+            while ((n = std::fread(chunk, 1, sizeof(chunk), in)) > 0)
+            {
+                pending.append(chunk, n);
+                auto consumed = decoder.decode(pending, [&](const spdlog::details::log_msg &msg) { formatter.format(msg, out); });
+                pending.erase(0, consumed);
+                std::fwrite(out.data(), 1, out.size(), stdout);
+                out.clear();
+            }
+            std::fclose(in);
+        }
+    }
+    catch (const std::exception &ex)
+    {
+        std::fprintf(stderr, "%s: %s\n", argv[0], ex.what());
+        return 1;
+    }
+
+    if (!pending.empty())
+    {
+        std::fprintf(stderr, "%s: ignoring %zu trailing bytes of a partial record\n", argv[0], pending.size());
+    }
+    return 0;
+}
+
+#else
+
+#include <cstdio>
+
+int main(int, char *[])
+{
+    std::fprintf(stderr, "binlog_to_json requires SPDLOG_JSON_LOGGER\n");
+    return 1;
+}
+
+#endif
@@ -73,16 +73,19 @@ inline std::shared_ptr<spdlog::logger> create_async_nb(std::string logger_name,
 }
 
 // set global thread pool.
-inline void init_thread_pool(size_t q_size, size_t thread_count, std::function<void()> on_thread_start)
+inline void init_thread_pool(size_t q_size, size_t thread_count, std::function<void()> on_thread_start,
+    async_queue_type queue_type = async_queue_type::blocking, async_pool_mode pool_mode = async_pool_mode::shared,
+    async_wait_strategy wait_strategy = async_wait_strategy::block)
 {
-    auto tp = std::make_shared<details::thread_pool>(q_size, thread_count, on_thread_start);
+    auto tp = std::make_shared<details::thread_pool>(q_size, thread_count, on_thread_start, queue_type, pool_mode, wait_strategy);
     details::registry::instance().set_tp(std::move(tp));
 }
 
 // set global thread pool.
-inline void init_thread_pool(size_t q_size, size_t thread_count)
+inline void init_thread_pool(size_t q_size, size_t thread_count, async_queue_type queue_type = async_queue_type::blocking,
+    async_pool_mode pool_mode = async_pool_mode::shared, async_wait_strategy wait_strategy = async_wait_strategy::block)
 {
-    init_thread_pool(q_size, thread_count, [] {});
+    init_thread_pool(q_size, thread_count, [] {}, queue_type, pool_mode, wait_strategy);
 }
 
 // get the global thread pool.
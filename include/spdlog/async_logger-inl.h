@@ -10,8 +10,47 @@
 #include <spdlog/sinks/sink.h>
 #include <spdlog/details/thread_pool.h>
 
+#include <algorithm>
+#include <iterator>
 #include <memory>
 #include <string>
+#include <vector>
+
+SPDLOG_INLINE spdlog::details::async_drop_counters::async_drop_counters()
+{
+    for (int i = 0; i < level::n_levels; i++)
+    {
+        pending[i].store(0, std::memory_order_relaxed);
+        total[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+SPDLOG_INLINE spdlog::details::async_drop_counters::async_drop_counters(const async_drop_counters &)
+    : async_drop_counters()
+{}
+
+SPDLOG_INLINE spdlog::details::async_drop_counters &spdlog::details::async_drop_counters::operator=(const async_drop_counters &)
+{
+    return *this;
+}
+
+SPDLOG_INLINE void spdlog::details::async_drop_counters::add(level::level_enum lvl)
+{
+    pending[lvl].fetch_add(1, std::memory_order_relaxed);
+    total[lvl].fetch_add(1, std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE bool spdlog::details::async_drop_counters::has_pending() const
+{
+    for (auto &counter : pending)
+    {
+        if (counter.load(std::memory_order_relaxed) > 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
 
 SPDLOG_INLINE spdlog::async_logger::async_logger(
     std::string logger_name, sinks_init_list sinks_list, std::weak_ptr<details::thread_pool> tp, async_overflow_policy overflow_policy)
@@ -36,6 +75,19 @@ SPDLOG_INLINE void spdlog::async_logger::sink_it_(const details::log_msg &msg)
     }
 }
 
+// move the message (and its params) into the queue instead of copying it
+SPDLOG_INLINE void spdlog::async_logger::sink_owned_(details::log_msg_buffer &&msg)
+{
+    if (auto pool_ptr = thread_pool_.lock())
+    {
+        pool_ptr->post_log(shared_from_this(), std::move(msg), overflow_policy_);
+    }
+    else
+    {
+        throw_spdlog_ex("async log: thread pool doesn't exist anymore");
+    }
+}
+
 // send flush request to the thread pool
 SPDLOG_INLINE void spdlog::async_logger::flush_()
 {
@@ -72,8 +124,68 @@ SPDLOG_INLINE void spdlog::async_logger::backend_sink_it_(const details::log_msg
     }
 }
 
+// hand consecutive messages to every sink at once.
+// each sink only gets the messages it should log.
+SPDLOG_INLINE void spdlog::async_logger::backend_sink_batch_(details::span<const details::log_msg *const> msgs)
+{
+    bool flush = backend_report_drops_(false);
+    std::vector<const details::log_msg *> filtered;
+    for (auto &sink : sinks_)
+    {
+        details::span<const details::log_msg *const> batch = msgs;
+        auto first_skipped =
+            std::find_if(msgs.begin(), msgs.end(), [&sink](const details::log_msg *msg) { return !sink->should_log(msg->level); });
+        if (first_skipped != msgs.end())
+        {
+            filtered.clear();
+            std::copy_if(
+                msgs.begin(), msgs.end(), std::back_inserter(filtered), [&sink](const details::log_msg *msg) { return sink->should_log(msg->level); });
+            batch = {filtered.data(), filtered.size()};
+        }
+        if (batch.empty())
+        {
+            continue;
+        }
+
+        size_t logged = 0;
+#ifdef SPDLOG_NO_EXCEPTIONS
+        sink->log_batch(batch, logged);
+#else
+        try
+        {
+            sink->log_batch(batch, logged);
+            continue;
+        }
+        catch (const std::exception &)
+        {
+            // the messages not logged yet are retried one by one below, as without batching,
+            // so that a failure is reported with the source of its message and skips only that message.
+        }
+        for (size_t i = logged; i < batch.size(); i++)
+        {
+            SPDLOG_TRY
+            {
+                sink->log(*batch[i]);
+            }
+            SPDLOG_LOGGER_CATCH(batch[i]->source)
+        }
+#endif
+    }
+
+    for (auto *msg : msgs)
+    {
+        flush = flush || should_flush_(*msg);
+    }
+    if (flush)
+    {
+        backend_flush_();
+    }
+}
+
 SPDLOG_INLINE void spdlog::async_logger::backend_flush_()
 {
+    // the summary is flushed below, with the rest
+    (void)backend_report_drops_(true);
     for (auto &sink : sinks_)
     {
         SPDLOG_TRY
@@ -84,6 +196,79 @@ SPDLOG_INLINE void spdlog::async_logger::backend_flush_()
     }
 }
 
+SPDLOG_INLINE bool spdlog::async_logger::backend_report_drops_(bool force)
+{
+    if (!drops_.has_pending())
+    {
+        return false;
+    }
+    auto now = log_clock::now();
+    auto last = drops_.last_summary.load(std::memory_order_relaxed);
+    auto last_tp = log_clock::time_point(log_clock::duration(static_cast<log_clock::rep>(last)));
+    if (!force && now - last_tp < std::chrono::seconds(SPDLOG_ASYNC_DROP_SUMMARY_INTERVAL))
+    {
+        return false;
+    }
+    // another worker may be writing a summary of this logger, which includes the pending drops
+    if (!drops_.last_summary.compare_exchange_strong(
+            last, static_cast<int64_t>(now.time_since_epoch().count()), std::memory_order_relaxed))
+    {
+        return false;
+    }
+
+    size_t dropped[level::n_levels];
+    size_t dropped_total = 0;
+    for (int i = 0; i < level::n_levels; i++)
+    {
+        dropped[i] = drops_.pending[i].exchange(0, std::memory_order_relaxed);
+        dropped_total += dropped[i];
+    }
+
+    memory_buf_t payload;
+    fmt::format_to(std::back_inserter(payload), "async queue overflow: dropped {} messages (", dropped_total);
+    const char *separator = "";
+    for (int i = 0; i < level::n_levels; i++)
+    {
+        if (dropped[i] > 0)
+        {
+            auto name = level::to_string_view(static_cast<level::level_enum>(i));
+            fmt::format_to(std::back_inserter(payload), "{}{} {}", separator, dropped[i], name);
+            separator = ", ";
+        }
+    }
+    payload.push_back(')');
+
+    details::log_msg_buffer summary(details::log_msg(now, source_loc{}, name_, level::warn, string_view_t(payload.data(), payload.size())));
+#ifdef SPDLOG_JSON_LOGGER
+    for (int i = 0; i < level::n_levels; i++)
+    {
+        if (dropped[i] > 0)
+        {
+            auto name = level::to_string_view(static_cast<level::level_enum>(i));
+            summary.add_field("dropped_" + std::string(name.data(), name.size()), static_cast<uint64_t>(dropped[i]));
+        }
+    }
+#endif
+    // straight to the sinks: backend_sink_it_() could flush, and the caller may be flushing already
+    for (auto &sink : sinks_)
+    {
+        if (sink->should_log(summary.level))
+        {
+            SPDLOG_TRY
+            {
+                sink->log(summary);
+            }
+            SPDLOG_LOGGER_CATCH(summary.source)
+        }
+    }
+    return should_flush_(summary);
+}
+
+SPDLOG_INLINE size_t spdlog::async_logger::dropped_count(level::level_enum lvl) const
+{
+    return drops_.total[lvl].load(std::memory_order_relaxed);
+}
+
 SPDLOG_INLINE std::shared_ptr<spdlog::logger> spdlog::async_logger::clone(std::string new_name)
 {
     auto cloned = std::make_shared<spdlog::async_logger>(*this);
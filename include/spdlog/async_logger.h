@@ -15,20 +15,70 @@
 // destructing..
 
 #include <spdlog/logger.h>
+#include <spdlog/details/span.h>
+
+#include <atomic>
+
+// minimum number of seconds between two summaries of the messages an async
+// logger dropped with async_overflow_policy::drop_by_level.
+#ifndef SPDLOG_ASYNC_DROP_SUMMARY_INTERVAL
+#    define SPDLOG_ASYNC_DROP_SUMMARY_INTERVAL 1
+#endif
 
 namespace spdlog {
 
 // Async overflow policy - block by default.
 enum class async_overflow_policy
 {
-    block,         // Block until message can be enqueued
-    overrun_oldest // Discard oldest message in the queue if full when trying to
-                   // add new item.
+    block,          // Block until message can be enqueued
+    overrun_oldest, // Discard oldest message in the queue if full when trying to
+                    // add new item.
+    drop_by_level   // Discard new messages whose level is below their watermark
+                    // (see thread_pool::set_drop_watermark()), so that low levels are
+                    // dropped first and higher ones keep the rest of the queue.
+                    // Block when the queue is full.
+};
+
+// Queue used by the async thread pool.
+enum class async_queue_type
+{
+    blocking, // mutex and condition variables (mpmc_blocking_queue)
+    lockfree  // lock-free bounded ring (mpmc_lockfree_queue). scales better
+              // with many producer threads.
+};
+
+// How the async thread pool spreads messages over its worker threads.
+enum class async_pool_mode
+{
+    shared, // all workers take messages from a single queue. with more than one
+            // worker, messages of a logger may be written out of order.
+    sharded // loggers are hashed onto per-worker queue shards. a shard is drained
+            // by one worker at a time, so each logger's messages stay in order,
+            // and idle workers steal whole shards from busy ones.
 };
 
 namespace details {
 class thread_pool;
-}
+
+// messages an async_logger dropped with async_overflow_policy::drop_by_level.
+// a copy (e.g. a cloned logger) starts with no drops.
+struct SPDLOG_API async_drop_counters
+{
+    // dropped since the last summary message, and in total
+    std::atomic<size_t> pending[level::n_levels];
+    std::atomic<size_t> total[level::n_levels];
+    // time of the last summary, in log_clock ticks. workers of a shared pool
+    // can handle the same logger at once, and claim the summary with a CAS.
+    std::atomic<int64_t> last_summary{0};
+
+    async_drop_counters();
+    async_drop_counters(const async_drop_counters &);
+    async_drop_counters &operator=(const async_drop_counters &);
+
+    void add(level::level_enum lvl);
+    bool has_pending() const;
+};
+} // namespace details
 
 class SPDLOG_API async_logger final : public std::enable_shared_from_this<async_logger>, public logger
 {
@@ -51,15 +101,26 @@ public:
 
     std::shared_ptr<logger> clone(std::string new_name) override;
 
+    // number of messages of the given level dropped with async_overflow_policy::drop_by_level.
+    size_t dropped_count(level::level_enum lvl) const;
+
 protected:
     void sink_it_(const details::log_msg &msg) override;
+    void sink_owned_(details::log_msg_buffer &&msg) override;
     void flush_() override;
     void backend_sink_it_(const details::log_msg &incoming_log_msg);
+    void backend_sink_batch_(details::span<const details::log_msg *const> msgs);
     void backend_flush_();
 
+    // log a summary of the messages dropped since the last one, if any.
+    // unless forced, at most once per SPDLOG_ASYNC_DROP_SUMMARY_INTERVAL seconds.
+    // the summary is not flushed: returns true if the flush level asks for it.
+    bool backend_report_drops_(bool force);
+
 private:
     std::weak_ptr<details::thread_pool> thread_pool_;
     async_overflow_policy overflow_policy_;
+    details::async_drop_counters drops_;
 };
 } // namespace spdlog
 
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <spdlog/common.h>
+
+#ifdef SPDLOG_JSON_LOGGER
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/binary_formatter.h>
+#endif
+
+#include <cstring>
+
+namespace spdlog {
+
+namespace details {
+
+// reserve room for the size of a record and write its type. return the offset of the record.
+SPDLOG_INLINE size_t begin_binary_record(binary_record type, memory_buf_t &dest)
+{
+    const size_t start = dest.size();
+    log_fields::append_raw(uint32_t{0}, dest);
+    dest.push_back(static_cast<char>(type));
+    return start;
+}
+
+// write the size of the record started at the given offset.
+SPDLOG_INLINE void end_binary_record(size_t start, memory_buf_t &dest)
+{
+    const auto size = static_cast<uint32_t>(dest.size() - start - sizeof(uint32_t));
+    std::memcpy(dest.data() + start, &size, sizeof(size));
+}
+
+// bounds checked reads from a single record.
+struct binary_record_reader
+{
+    const char *p;
+    const char *end;
+
+    void require(size_t n) const
+    {
+        if (static_cast<size_t>(end - p) < n)
+        {
+            throw_spdlog_ex("binary_decoder: truncated record");
+        }
+    }
+
+    template<typename T>
+    T raw()
+    {
+        require(sizeof(T));
+        return log_fields::read_raw<T>(p);
+    }
+
+    string_view_t string()
+    {
+        const auto size = raw<uint32_t>();
+        require(size);
+        string_view_t s(p, size);
+        p += size;
+        return s;
+    }
+
+    // check that the rest of the record holds typed fields encoded by log_fields,
+    // with plain keys, so that the unchecked log_fields readers can decode them.
+    void check_fields() const
+    {
+        binary_record_reader in{p, end};
+        while (in.p < in.end)
+        {
+            const auto type = in.raw<uint8_t>();
+            if (type > static_cast<uint8_t>(field_type::string))
+            {
+                throw_spdlog_ex("binary_decoder: invalid field type " + std::to_string(type));
+            }
+            in.string();
+            switch (static_cast<field_type>(type))
+            {
+            case field_type::null:
+                break;
+            case field_type::boolean:
+                in.raw<uint8_t>();
+                break;
+            case field_type::int64:
+            case field_type::uint64:
+            case field_type::float64:
+                in.raw<uint64_t>();
+                break;
+            case field_type::string:
+                in.string();
+                break;
+            }
+        }
+    }
+};
+
+} // namespace details
+
+SPDLOG_INLINE binary_formatter::binary_formatter()
+    : adapter_(std::make_shared<details::memory_buf_output_adapter>())
+    , cbor_(details::make_unique<nlohmann::detail::binary_writer<nlohmann::json, char>>(adapter_))
+{}
+
+SPDLOG_INLINE void binary_formatter::format(const details::log_msg &msg, memory_buf_t &dest)
+{
+    using details::log_fields::append_raw;
+    using details::log_fields::append_string;
+
+    const auto logger_id = logger_id_(msg.logger_name, dest);
+    const auto start = details::begin_binary_record(binary_record::message, dest);
+
+    append_raw(static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(msg.time.time_since_epoch()).count()), dest);
+    dest.push_back(static_cast<char>(msg.level));
+    append_raw(logger_id, dest);
+    append_raw(static_cast<uint64_t>(msg.thread_id), dest);
+
+    append_string(msg.source.filename ? string_view_t(msg.source.filename) : string_view_t(), dest);
+    append_raw(static_cast<int32_t>(msg.source.line), dest);
+    append_string(msg.source.funcname ? string_view_t(msg.source.funcname) : string_view_t(), dest);
+    append_string(msg.payload, dest);
+
+    const size_t params_start = dest.size();
+    append_raw(uint32_t{0}, dest);
+    if (msg.params && !msg.params->empty())
+    {
+        adapter_->dest = &dest;
+        cbor_->write_cbor(*msg.params);
+        const auto params_size = static_cast<uint32_t>(dest.size() - params_start - sizeof(uint32_t));
+        std::memcpy(dest.data() + params_start, &params_size, sizeof(params_size));
+    }
+
+    details::log_fields::portable_copy(msg.fields, dest);
+    details::end_binary_record(start, dest);
+}
+
+SPDLOG_INLINE std::unique_ptr<formatter> binary_formatter::clone() const
+{
+    return details::make_unique<binary_formatter>();
+}
+
+SPDLOG_INLINE uint32_t binary_formatter::logger_id_(string_view_t name, memory_buf_t &dest)
+{
+    // messages usually come from a handful of loggers, often the same one in a row
+    auto matches = [name](const std::string &s) { return s.size() == name.size() && std::memcmp(s.data(), name.data(), name.size()) == 0; };
+    if (last_logger_id_ < logger_names_.size() && matches(logger_names_[last_logger_id_]))
+    {
+        return static_cast<uint32_t>(last_logger_id_);
+    }
+    for (size_t id = 0; id < logger_names_.size(); ++id)
+    {
+        if (matches(logger_names_[id]))
+        {
+            last_logger_id_ = id;
+            return static_cast<uint32_t>(id);
+        }
+    }
+
+    last_logger_id_ = logger_names_.size();
+    logger_names_.emplace_back(name.data(), name.size());
+    const auto start = details::begin_binary_record(binary_record::logger_name, dest);
+    details::log_fields::append_raw(static_cast<uint32_t>(last_logger_id_), dest);
+    details::log_fields::append_string(name, dest);
+    details::end_binary_record(start, dest);
+    return static_cast<uint32_t>(last_logger_id_);
+}
+
+SPDLOG_INLINE bool binary_decoder::read_record_(string_view_t record)
+{
+    details::binary_record_reader in{record.data(), record.data() + record.size()};
+
+    const auto type = static_cast<binary_record>(in.raw<uint8_t>());
+    if (type == binary_record::logger_name)
+    {
+        const auto id = in.raw<uint32_t>();
+        const auto name = in.string();
+        logger_names_[id].assign(name.data(), name.size());
+        return false;
+    }
+    if (type != binary_record::message)
+    {
+        throw_spdlog_ex("binary_decoder: unknown record type " + std::to_string(static_cast<int>(type)));
+    }
+
+    const auto nanos = in.raw<int64_t>();
+    const auto level = in.raw<uint8_t>();
+    const auto logger_id = in.raw<uint32_t>();
+    const auto thread_id = in.raw<uint64_t>();
+    const auto filename = in.string();
+    const auto line = in.raw<int32_t>();
+    const auto funcname = in.string();
+    const auto payload = in.string();
+    const auto params = in.string();
+    in.check_fields();
+    if (level >= level::n_levels)
+    {
+        throw_spdlog_ex("binary_decoder: invalid level " + std::to_string(level));
+    }
+    auto logger_name = logger_names_.find(logger_id);
+    if (logger_name == logger_names_.end())
+    {
+        throw_spdlog_ex("binary_decoder: unknown logger id " + std::to_string(logger_id));
+    }
+
+    msg_ = details::log_msg();
+    msg_.time = log_clock::time_point(std::chrono::duration_cast<log_clock::duration>(std::chrono::nanoseconds(nanos)));
+    msg_.level = static_cast<level::level_enum>(level);
+    msg_.logger_name = logger_name->second;
+    msg_.thread_id = static_cast<size_t>(thread_id);
+    if (filename.size() > 0)
+    {
+        filename_.assign(filename.data(), filename.size());
+        funcname_.assign(funcname.data(), funcname.size());
+        msg_.source = source_loc{filename_.c_str(), line, funcname_.c_str()};
+    }
+    msg_.payload = payload;
+    if (params.size() > 0)
+    {
+        params_ = nlohmann::json::from_cbor(params.data(), params.data() + params.size());
+        msg_.params = &params_;
+    }
+    msg_.fields = string_view_t(in.p, static_cast<size_t>(in.end - in.p));
+    return true;
+}
+
+} // namespace spdlog
+
+#endif
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <spdlog/common.h>
+
+#ifdef SPDLOG_JSON_LOGGER
+
+#include <spdlog/details/log_fields.h>
+#include <spdlog/formatter.h>
+#include <spdlog/json_writer.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Compact binary encoding of log messages, rendered to JSON offline.
+// The output is a sequence of length-prefixed records:
+//
+//   [record size (uint32)][record type (1 byte)][body]
+//
+// where the record size covers the type and the body. Bodies are:
+//
+//   logger_name: [id (uint32)][name]
+//   message:     [time (int64, ns since epoch)][level (1 byte)][logger id (uint32)][thread id (uint64)]
+//                [source file][source line (int32)][source function][payload]
+//                [params size (uint32)][params as CBOR][typed fields (rest of the record)]
+//
+// Strings are a uint32 size followed by the bytes (see details/log_fields.h),
+// typed fields are encoded by details::log_fields with interned keys written
+// as plain strings, and numbers are in host byte order. A logger name is
+// written once per formatter, in a logger_name record preceding its first
+// message.
+
+namespace spdlog {
+
+enum class binary_record : uint8_t
+{
+    logger_name,
+    message
+};
+
+class SPDLOG_API binary_formatter : public formatter
+{
+public:
+    binary_formatter();
+
+    binary_formatter(const binary_formatter &) = delete;
+    binary_formatter &operator=(const binary_formatter &) = delete;
+
+    virtual void format(const details::log_msg &msg, memory_buf_t &dest) override;
+
+    // the clone starts with an empty logger name table, as it writes to another destination.
+    virtual std::unique_ptr<formatter> clone() const override;
+
+private:
+    std::vector<std::string> logger_names_;
+    size_t last_logger_id_{0};
+    std::shared_ptr<details::memory_buf_output_adapter> adapter_;
+    std::unique_ptr<nlohmann::detail::binary_writer<nlohmann::json, char>> cbor_;
+
+    // return the id of the given logger name, writing a logger_name record if it is new.
+    uint32_t logger_id_(string_view_t name, memory_buf_t &dest);
+};
+
+// Decodes the output of binary_formatter back into log messages,
+// which can then be handed to any formatter (e.g. json_formatter).
+class SPDLOG_API binary_decoder
+{
+public:
+    // decode the complete records at the start of data and call fun(const details::log_msg &)
+    // for each message. the message and its views are only valid during the call.
+    // return the number of bytes consumed. a trailing partial record is left for the next call.
+    template<typename Fun>
+    size_t decode(string_view_t data, Fun fun)
+    {
+        size_t pos = 0;
+        while (data.size() - pos >= sizeof(uint32_t))
+        {
+            const char *p = data.data() + pos;
+            auto size = details::log_fields::read_raw<uint32_t>(p);
+            if (data.size() - pos - sizeof(uint32_t) < size)
+            {
+                break;
+            }
+            if (read_record_(string_view_t(p, size)))
+            {
+                fun(static_cast<const details::log_msg &>(msg_));
+            }
+            pos += sizeof(uint32_t) + size;
+        }
+        return pos;
+    }
+
+private:
+    // by id. the ids come from the input, so they are not used as indices.
+    std::unordered_map<uint32_t, std::string> logger_names_;
+    std::string filename_;
+    std::string funcname_;
+    nlohmann::json params_;
+    details::log_msg msg_;
+
+    // decode a single record. return true if it is a message, which is then held by msg_.
+    bool read_record_(string_view_t record);
+};
+
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "binary_formatter-inl.h"
+#endif
+
+#endif
@@ -226,6 +226,37 @@ enum class pattern_time_type
     utc    // log utc
 };
 
+//
+// How file sinks write to their files (see details::file_helper).
+//
+enum class file_backend
+{
+    stdio,   // a buffered FILE*
+    fd,      // posix: a raw file descriptor and a buffer of file_options::buffer_size bytes, written with writev()
+    io_uring // linux: as fd, but a full buffer is written by io_uring while the next one fills. falls back to fd
+};
+
+//
+// When file sinks ask the os to write their data to the disk (fdatasync).
+//
+enum class file_sync
+{
+    none,     // never, the os writes it back in its own time
+    on_flush, // on every flush, and on close
+    interval  // when the data reaches the file, at most once per file_options::sync_interval, and on close
+};
+
+struct file_options
+{
+    file_backend backend = file_backend::stdio;
+    // size of the buffer of the fd and io_uring backends. the buffer is only
+    // written out when full or flushed, so use a periodic flush (spdlog::flush_every)
+    // to bound how long messages can stay in it.
+    size_t buffer_size = 64 * 1024;
+    file_sync sync = file_sync::none;
+    std::chrono::milliseconds sync_interval{1000};
+};
+
 //
 // Log exception
 //
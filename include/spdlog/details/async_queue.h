@@ -0,0 +1,103 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// bounded queue interface used by thread_pool.
+// implemented by mpmc_blocking_queue and mpmc_lockfree_queue, which both
+// wait according to an async_wait_strategy.
+
+#include <chrono>
+#include <cstddef>
+#include <thread>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#    include <intrin.h>
+#endif
+
+namespace spdlog {
+
+// How the async queues and the thread pool wait for messages (consumers) or room (blocked producers).
+enum class async_wait_strategy
+{
+    block,      // sleep on a condition variable. the other side only signals it
+                // when someone actually sleeps.
+    spin_yield, // spin for a while, then yield the cpu between polls. never sleeps.
+    busy_spin   // spin on the cpu between polls. lowest latency, costs a core per waiting thread.
+};
+
+namespace details {
+
+// pauses between the polls of a spinning wait.
+class spin_waiter
+{
+public:
+    // polls before spin_yield starts yielding the cpu
+    static constexpr int spin_count = 64;
+
+    explicit spin_waiter(async_wait_strategy strategy)
+        : strategy_(strategy)
+    {}
+
+    void pause()
+    {
+        if (strategy_ == async_wait_strategy::busy_spin || spins_ < spin_count)
+        {
+            spins_++;
+            cpu_relax();
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    static void cpu_relax()
+    {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+private:
+    async_wait_strategy strategy_;
+    int spins_{0};
+};
+
+template<typename T>
+class async_queue
+{
+public:
+    using item_type = T;
+
+    virtual ~async_queue() = default;
+
+    // try to enqueue and block if no room left
+    virtual void enqueue(T &&item) = 0;
+
+    // enqueue immediately. overrun oldest message in the queue if no room left.
+    virtual void enqueue_nowait(T &&item) = 0;
+
+    // try to dequeue item. if no item found. wait upto timeout and try again
+    // Return true, if succeeded dequeue item, false otherwise
+    virtual bool dequeue_for(T &popped_item, std::chrono::milliseconds wait_duration) = 0;
+
+    // dequeue up to max_items at once. wait upto timeout for the first one.
+    // Return the number of dequeued items
+    virtual size_t dequeue_bulk_for(T *popped_items, size_t max_items, std::chrono::milliseconds wait_duration) = 0;
+
+    // dequeue up to max_items at once without waiting.
+    // Return the number of dequeued items
+    virtual size_t try_dequeue_bulk(T *popped_items, size_t max_items) = 0;
+
+    virtual size_t overrun_counter() = 0;
+
+    virtual size_t size() = 0;
+};
+
+} // namespace details
+} // namespace spdlog
@@ -10,34 +10,97 @@
 
 #include <spdlog/logger.h>
 
+#include <vector>
+
 namespace spdlog {
 
 namespace details {
 
-SPDLOG_INLINE executor::context::context(logger *lgr, const log_msg &msg, bool log_enabled, bool traceback_enabled)
-    : lgr(lgr)
-    , msg(msg)
-    , log_enabled(log_enabled)
-    , traceback_enabled(traceback_enabled)
-{}
+#ifndef SPDLOG_NO_TLS
+// contexts released by the current thread, ready for reuse.
+template<typename Context>
+struct executor_context_pool
+{
+    std::vector<Context *> free;
 
-SPDLOG_INLINE executor::context::context(context &&other)
-    : lgr(other.lgr)
-    , msg(std::move(other.msg))
-    , log_enabled(other.log_enabled)
-    , traceback_enabled(other.traceback_enabled)
-{}
+    executor_context_pool()
+    {
+        alive_() = true;
+    }
+
+    ~executor_context_pool()
+    {
+        alive_() = false;
+        for (auto *ctx : free)
+        {
+            delete ctx;
+        }
+    }
+
+    // nullptr once the pool of the current thread was destroyed: messages can still be
+    // logged from the destructors of static or other thread local objects.
+    static executor_context_pool *instance()
+    {
+        static thread_local executor_context_pool pool;
+        return alive_() ? &pool : nullptr;
+    }
+
+private:
+    // trivially destructible, so still readable after the pool is destroyed
+    static bool &alive_()
+    {
+        static thread_local bool alive = false;
+        return alive;
+    }
+};
+#endif
+
+SPDLOG_INLINE executor::context *executor::acquire_context_(logger *lgr, bool log_enabled, bool traceback_enabled)
+{
+    context *ctx = nullptr;
+#ifndef SPDLOG_NO_TLS
+    auto *pool = executor_context_pool<context>::instance();
+    if (pool != nullptr && !pool->free.empty())
+    {
+        ctx = pool->free.back();
+        pool->free.pop_back();
+    }
+#endif
+    if (ctx == nullptr)
+    {
+        ctx = new context();
+    }
+    ctx->lgr = lgr;
+    ctx->log_enabled = log_enabled;
+    ctx->traceback_enabled = traceback_enabled;
+    return ctx;
+}
+
+SPDLOG_INLINE void executor::release_context_(context *ctx)
+{
+#ifndef SPDLOG_NO_TLS
+    auto *pool = executor_context_pool<context>::instance();
+    if (pool != nullptr && pool->free.size() < max_pooled_contexts)
+    {
+        pool->free.push_back(ctx);
+        return;
+    }
+#endif
+    delete ctx;
+}
 
 SPDLOG_INLINE executor::executor()
     : ctx_(nullptr)
 {}
 
 SPDLOG_INLINE executor::executor(logger *lgr, const log_msg &msg, bool log_enabled, bool traceback_enabled)
-    : ctx_(new (buf_) context(lgr, msg, log_enabled, traceback_enabled))
-{}
+    : ctx_(acquire_context_(lgr, log_enabled, traceback_enabled))
+{
+    ctx_->msg.assign(msg);
+}
 
 SPDLOG_INLINE executor::executor(executor &&other)
-    : ctx_(other.ctx_ ? new (buf_) context(std::move(*other.ctx_)) : nullptr)
+    : ctx_(other.ctx_)
 {
     other.ctx_ = nullptr;
 }
@@ -49,14 +112,14 @@ SPDLOG_INLINE executor::~executor() noexcept(false)
         ctx_->msg.params = &ctx_->msg.params_buffer;
         try
         {
-            ctx_->lgr->executor_callback(ctx_->msg, ctx_->log_enabled, ctx_->traceback_enabled);
+            ctx_->lgr->executor_callback(std::move(ctx_->msg), ctx_->log_enabled, ctx_->traceback_enabled);
         }
         catch (...)
         {
-            ctx_->~context();
+            release_context_(ctx_);
             throw;
         }
-        ctx_->~context();
+        release_context_(ctx_);
     }
 }
 
@@ -72,6 +135,73 @@ SPDLOG_INLINE executor &executor::operator()(const nlohmann::json &params)
     return *this;
 }
 
+SPDLOG_INLINE executor &executor::operator()(nlohmann::json &&params)
+{
+    if (ctx_)
+    {
+        auto &buffer = ctx_->msg.params_buffer;
+        if (buffer.is_null() && params.is_object())
+        {
+            // first params of the entry: take over the whole object
+            buffer = std::move(params);
+        }
+        else
+        {
+            for (auto &kv : params.items())
+            {
+                buffer[kv.key()] = std::move(kv.value());
+            }
+        }
+    }
+    return *this;
+}
+
+SPDLOG_INLINE executor &executor::field(const field_name &key, std::nullptr_t)
+{
+    if (ctx_)
+    {
+        ctx_->msg.add_field(key, nullptr);
+    }
+    return *this;
+}
+
+SPDLOG_INLINE executor &executor::field(const field_name &key, bool value)
+{
+    if (ctx_)
+    {
+        ctx_->msg.add_field(key, value);
+    }
+    return *this;
+}
+
+SPDLOG_INLINE executor &executor::field(const field_name &key, double value)
+{
+    if (ctx_)
+    {
+        ctx_->msg.add_field(key, value);
+    }
+    return *this;
+}
+
+SPDLOG_INLINE executor &executor::field(const field_name &key, string_view_t value)
+{
+    if (ctx_)
+    {
+        ctx_->msg.add_field(key, value);
+    }
+    return *this;
+}
+
+SPDLOG_INLINE executor &executor::field(const field_name &key, const char *value)
+{
+    return field(key, string_view_t(value));
+}
+
+SPDLOG_INLINE executor &executor::field(const field_name &key, const std::string &value)
+{
+    return field(key, string_view_t(value.data(), value.size()));
+}
+
 } // namespace details
 
 } // namespace spdlog
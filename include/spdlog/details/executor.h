@@ -7,12 +7,18 @@
 #include <spdlog/details/log_msg_buffer.h>
 #include <spdlog/json.h>
 
+#include <type_traits>
+#include <utility>
+
 namespace spdlog {
 
 class logger;
 
 namespace details {
 
+// Handle to the entry being logged, returned by the logger's log methods.
+// The entry itself lives in a context taken from a small thread local pool,
+// so the executor is a single pointer and returning or moving it is cheap.
 class SPDLOG_API executor
 {
 private:
@@ -22,18 +28,41 @@ private:
         log_msg_buffer msg;
         bool log_enabled;
         bool traceback_enabled;
-
-        context(logger *lgr, const log_msg &msg, bool log_enabled, bool traceback_enabled);
-        context(context &&other);
     };
 
-    uint8_t buf_[sizeof(context)];
+    // most contexts kept for reuse by each thread
+    static constexpr size_t max_pooled_contexts = 16;
 
     context *ctx_;
 
+    static context *acquire_context_(logger *lgr, bool log_enabled, bool traceback_enabled);
+    static void release_context_(context *ctx);
+
 public:
     executor();
     executor(logger *lgr, const log_msg &msg, bool log_enabled, bool traceback_enabled);
+
+    // same, but the payload is written by write_payload(memory_buf_t &) straight into the
+    // message buffer of the entry, instead of being formatted elsewhere and copied in.
+    // msg must have an empty payload and no fields.
+    template<typename Write>
+    executor(logger *lgr, const log_msg &msg, bool log_enabled, bool traceback_enabled, Write &&write_payload)
+        : ctx_(acquire_context_(lgr, log_enabled, traceback_enabled))
+    {
+#ifdef SPDLOG_NO_EXCEPTIONS
+        ctx_->msg.assign_formatted(msg, write_payload);
+#else
+        try
+        {
+            ctx_->msg.assign_formatted(msg, write_payload);
+        }
+        catch (...)
+        {
+            release_context_(ctx_);
+            throw;
+        }
+#endif
+    }
     executor(const executor &other) = delete;
     executor(executor &&other);
 
@@ -43,6 +72,58 @@ public:
     executor &operator=(executor &&other) = delete;
 
     executor &operator()(const nlohmann::json &params);
+
+    // same, but the fields are moved into the message instead of being deep copied.
+    // params built in the call, e.g. logger->info("...")({{"key", value}}), take this path.
+    executor &operator()(nlohmann::json &&params);
+
+    // lazy params: fun is only invoked if the entry is going to be logged.
+    // fun either returns the params, or takes the executor and adds fields to it.
+    template<typename Fun>
+    auto operator()(Fun &&fun) -> decltype(nlohmann::json(fun()), std::declval<executor &>())
+    {
+        if (ctx_)
+        {
+            (*this)(nlohmann::json(fun()));
+        }
+        return *this;
+    }
+
+    template<typename Fun>
+    auto operator()(Fun &&fun) -> decltype(fun(std::declval<executor &>()), std::declval<executor &>())
+    {
+        if (ctx_)
+        {
+            fun(*this);
+        }
+        return *this;
+    }
+
+    // false if the entry is neither logged nor traced (e.g. its level is disabled).
+    bool enabled() const
+    {
+        return ctx_ != nullptr;
+    }
+
+    // typed fields. they are encoded into the message buffer as is and never touch nlohmann::json,
+    // unless a formatter needs to build a DOM. keys are strings or interned field_keys.
+    executor &field(const field_name &key, std::nullptr_t);
+    executor &field(const field_name &key, bool value);
+    executor &field(const field_name &key, double value);
+    executor &field(const field_name &key, string_view_t value);
+    executor &field(const field_name &key, const char *value);
+    executor &field(const field_name &key, const std::string &value);
+
+    template<typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, int>::type = 0>
+    executor &field(const field_name &key, T value)
+    {
+        if (ctx_)
+        {
+            using encoded_t = typename std::conditional<std::is_signed<T>::value, int64_t, uint64_t>::type;
+            ctx_->msg.add_field(key, static_cast<encoded_t>(value));
+        }
+        return *this;
+    }
 };
 
 } // namespace details
@@ -10,16 +10,35 @@
 #include <spdlog/details/os.h>
 #include <spdlog/common.h>
 
+#ifdef _WIN32
+#    include <io.h> // _commit, _fileno
+#else
+#    include <fcntl.h>
+#    include <sys/stat.h>
+#    include <sys/uio.h>
+#    include <unistd.h>
+#endif
+
+#include <spdlog/details/io_uring_writer.h>
+
+#include <algorithm>
 #include <cerrno>
 #include <chrono>
 #include <cstdio>
 #include <string>
 #include <thread>
 #include <tuple>
+#include <utility>
 
 namespace spdlog {
 namespace details {
 
+SPDLOG_INLINE file_helper::file_helper() = default;
+
+SPDLOG_INLINE file_helper::file_helper(const file_options &options)
+    : options_(options)
+{}
+
 SPDLOG_INLINE file_helper::~file_helper()
 {
     close();
@@ -30,28 +49,13 @@ SPDLOG_INLINE void file_helper::open(const filename_t &fname, bool truncate)
     close();
     filename_ = fname;
 
-    auto *mode = SPDLOG_FILENAME_T("ab");
-    auto *trunc_mode = SPDLOG_FILENAME_T("wb");
-
     for (int tries = 0; tries < open_tries_; ++tries)
     {
         // create containing folder if not exists already.
         os::create_dir(os::dir_name(fname));
-        if (truncate)
-        {
-            // Truncate by opening-and-closing a tmp file in "wb" mode, always
-            // opening the actual log-we-write-to in "ab" mode, since that
-            // interacts more politely with eternal processes that might
-            // rotate/truncate the file underneath us.
-            std::FILE *tmp;
-            if (os::fopen_s(&tmp, fname, trunc_mode))
-            {
-                continue;
-            }
-            std::fclose(tmp);
-        }
-        if (!os::fopen_s(&fd_, fname, mode))
+        if (open_(fname, truncate))
         {
+            last_sync_ = std::chrono::steady_clock::now();
             return;
         }
 
@@ -61,6 +65,50 @@ SPDLOG_INLINE void file_helper::open(const filename_t &fname, bool truncate)
     throw_spdlog_ex("Failed opening file " + os::filename_to_str(filename_) + " for writing", errno);
 }
 
+SPDLOG_INLINE bool file_helper::open_(const filename_t &fname, bool truncate)
+{
+#ifndef _WIN32
+    if (options_.backend != file_backend::stdio)
+    {
+        int flags = O_WRONLY | O_CREAT | O_APPEND;
+#    ifdef O_CLOEXEC
+        flags |= O_CLOEXEC;
+#    endif
+        if (truncate)
+        {
+            flags |= O_TRUNC;
+        }
+        raw_fd_ = ::open(fname.c_str(), flags, 0644);
+        if (raw_fd_ == -1)
+        {
+            return false;
+        }
+        buffer_.reserve(options_.buffer_size);
+        // kept across reopens. without io_uring, this is the fd backend.
+        if (options_.backend == file_backend::io_uring && !uring_)
+        {
+            uring_ = io_uring_writer::create();
+        }
+        return true;
+    }
+#endif
+
+    if (truncate)
+    {
+        // Truncate by opening-and-closing a tmp file in "wb" mode, always
+        // opening the actual log-we-write-to in "ab" mode, since that
+        // interacts more politely with eternal processes that might
+        // rotate/truncate the file underneath us.
+        std::FILE *tmp;
+        if (os::fopen_s(&tmp, fname, SPDLOG_FILENAME_T("wb")))
+        {
+            return false;
+        }
+        std::fclose(tmp);
+    }
+    return !os::fopen_s(&fd_, fname, SPDLOG_FILENAME_T("ab"));
+}
+
 SPDLOG_INLINE void file_helper::reopen(bool truncate)
 {
     if (filename_.empty())
@@ -72,30 +120,116 @@ SPDLOG_INLINE void file_helper::reopen(bool truncate)
 
 SPDLOG_INLINE void file_helper::flush()
 {
-    std::fflush(fd_);
+    if (raw_fd_ != -1)
+    {
+        wait_in_flight_();
+        write_buffer_(buffer_, nullptr, 0);
+    }
+    else
+    {
+        std::fflush(fd_);
+    }
+
+    if (options_.sync == file_sync::on_flush)
+    {
+        sync_();
+    }
+    else
+    {
+        sync_if_due_();
+    }
 }
 
+// the buffered data is written (and synced, unless file_sync::none) before closing.
+// errors are ignored, as fclose() does.
 SPDLOG_INLINE void file_helper::close()
 {
+    if (fd_ == nullptr && raw_fd_ == -1)
+    {
+        return;
+    }
+    SPDLOG_TRY
+    {
+        if (raw_fd_ != -1)
+        {
+            wait_in_flight_();
+            write_buffer_(buffer_, nullptr, 0);
+        }
+        else if (options_.sync != file_sync::none)
+        {
+            std::fflush(fd_);
+        }
+        if (options_.sync != file_sync::none)
+        {
+            sync_();
+        }
+    }
+    SPDLOG_CATCH_STD
+
     if (fd_ != nullptr)
     {
         std::fclose(fd_);
         fd_ = nullptr;
     }
+#ifndef _WIN32
+    if (raw_fd_ != -1)
+    {
+        buffer_.clear();
+        // kept if the kernel may still be reading it (see wait_in_flight_)
+        if (!uring_ || !uring_->pending())
+        {
+            in_flight_.clear();
+        }
+        ::close(raw_fd_);
+        raw_fd_ = -1;
+    }
+#endif
 }
 
 SPDLOG_INLINE void file_helper::write(const memory_buf_t &buf)
 {
     size_t msg_size = buf.size();
     auto data = buf.data();
-    if (std::fwrite(data, 1, msg_size, fd_) != msg_size)
+    if (raw_fd_ != -1)
+    {
+        if (buffer_.size() + msg_size <= options_.buffer_size)
+        {
+            buffer_.append(data, data + msg_size);
+            return;
+        }
+        if (uring_)
+        {
+            buffer_.append(data, data + msg_size);
+            submit_buffer_();
+        }
+        else
+        {
+            // the buffer and the new data go out together, without copying the data
+            write_buffer_(buffer_, data, msg_size);
+        }
+    }
+    else if (std::fwrite(data, 1, msg_size, fd_) != msg_size)
     {
         throw_spdlog_ex("Failed writing to file " + os::filename_to_str(filename_), errno);
     }
+    sync_if_due_();
 }
 
 SPDLOG_INLINE size_t file_helper::size() const
 {
+#ifndef _WIN32
+    if (raw_fd_ != -1)
+    {
+        // what is in flight is counted by neither the buffer nor (until done) the file
+        const_cast<file_helper *>(this)->wait_in_flight_();
+        struct stat st;
+        if (::fstat(raw_fd_, &st) != 0)
+        {
+            throw_spdlog_ex("Failed getting file size of " + os::filename_to_str(filename_), errno);
+        }
+        return static_cast<size_t>(st.st_size) + buffer_.size();
+    }
+#endif
     if (fd_ == nullptr)
     {
         throw_spdlog_ex("Cannot use size() on closed file " + os::filename_to_str(filename_));
@@ -108,6 +242,143 @@ SPDLOG_INLINE const filename_t &file_helper::filename() const
     return filename_;
 }
 
+// write the buffer, then the data, and clear the buffer.
+// if the write fails, only what was not written stays in the buffer, so that it is not written twice.
+SPDLOG_INLINE void file_helper::write_buffer_(memory_buf_t &buf, const char *data, size_t size)
+{
+    size_t written = 0;
+    int err = write_fd_(buf.data(), buf.size(), data, size, written);
+    drop_front_(buf, written);
+    if (err != 0)
+    {
+        throw_spdlog_ex("Failed writing to file " + os::filename_to_str(filename_), err);
+    }
+}
+
+SPDLOG_INLINE void file_helper::drop_front_(memory_buf_t &buf, size_t n)
+{
+    if (n >= buf.size())
+    {
+        buf.clear();
+        return;
+    }
+    std::copy(buf.data() + n, buf.data() + buf.size(), buf.data());
+    buf.resize(buf.size() - n);
+}
+
+SPDLOG_INLINE int file_helper::write_fd_(const char *data1, size_t size1, const char *data2, size_t size2, size_t &written_total)
+{
+    written_total = 0;
+#ifndef _WIN32
+    struct iovec iov[2];
+    iov[0].iov_base = const_cast<char *>(data1);
+    iov[0].iov_len = size1;
+    iov[1].iov_base = const_cast<char *>(data2);
+    iov[1].iov_len = size2;
+    struct iovec *pending = iov;
+    int count = 2;
+    while (count > 0)
+    {
+        // skip what was written, including empty buffers
+        if (pending->iov_len == 0)
+        {
+            ++pending;
+            --count;
+            continue;
+        }
+        auto rv = ::writev(raw_fd_, pending, count);
+        if (rv < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return errno;
+        }
+        auto written = static_cast<size_t>(rv);
+        written_total += written;
+        while (count > 0 && written >= pending->iov_len)
+        {
+            written -= pending->iov_len;
+            ++pending;
+            --count;
+        }
+        if (count > 0)
+        {
+            pending->iov_base = static_cast<char *>(pending->iov_base) + written;
+            pending->iov_len -= written;
+        }
+    }
+#else
+    (void)data1;
+    (void)size1;
+    (void)data2;
+    (void)size2;
+#endif
+    return 0;
+}
+
+// hand the full buffer to io_uring, once the previous one is written, and go on with the other one
+SPDLOG_INLINE void file_helper::submit_buffer_()
+{
+    wait_in_flight_();
+    std::swap(buffer_, in_flight_);
+    if (!uring_->submit(raw_fd_, in_flight_.data(), in_flight_.size()))
+    {
+        write_buffer_(in_flight_, nullptr, 0);
+    }
+}
+
+SPDLOG_INLINE void file_helper::wait_in_flight_()
+{
+    if (!uring_ || !uring_->pending())
+    {
+        return;
+    }
+    int rv = uring_->wait();
+    if (rv < 0)
+    {
+        // without a completion, the kernel may still be reading the buffer: keep it until the next wait.
+        // with one, the write failed and nothing was written.
+        if (!uring_->pending())
+        {
+            in_flight_.clear();
+        }
+        throw_spdlog_ex("Failed writing to file " + os::filename_to_str(filename_), -rv);
+    }
+    // complete a short write
+    drop_front_(in_flight_, static_cast<size_t>(rv));
+    write_buffer_(in_flight_, nullptr, 0);
+}
+
+// ask the os to write the data it has to the disk. the stdio buffer is not flushed.
+SPDLOG_INLINE void file_helper::sync_()
+{
+#ifdef _WIN32
+    bool ok = fd_ == nullptr || ::_commit(::_fileno(fd_)) == 0;
+#else
+    int fd = raw_fd_ != -1 ? raw_fd_ : (fd_ != nullptr ? ::fileno(fd_) : -1);
+#    if defined(__linux__) || defined(__FreeBSD__)
+    bool ok = fd == -1 || ::fdatasync(fd) == 0;
+#    else
+    bool ok = fd == -1 || ::fsync(fd) == 0;
+#    endif
+#endif
+    if (!ok)
+    {
+        throw_spdlog_ex("Failed syncing file " + os::filename_to_str(filename_), errno);
+    }
+    last_sync_ = std::chrono::steady_clock::now();
+}
+
+SPDLOG_INLINE void file_helper::sync_if_due_()
+{
+    if (options_.sync == file_sync::interval && std::chrono::steady_clock::now() - last_sync_ >= options_.sync_interval)
+    {
+        sync_();
+    }
+}
+
 //
 // return file path and its extension:
 //
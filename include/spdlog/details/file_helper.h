@@ -4,19 +4,25 @@
 #pragma once
 
 #include <spdlog/common.h>
+#include <chrono>
+#include <memory>
 #include <tuple>
 
 namespace spdlog {
 namespace details {
 
+class io_uring_writer;
+
 // Helper class for file sinks.
 // When failing to open a file, retry several times(5) with a delay interval(10 ms).
 // Throw spdlog_ex exception on errors.
+// The file_options select how the file is written (stdio by default) and synced.
 
 class SPDLOG_API file_helper
 {
 public:
-    explicit file_helper() = default;
+    explicit file_helper();
+    explicit file_helper(const file_options &options);
 
     file_helper(const file_helper &) = delete;
     file_helper &operator=(const file_helper &) = delete;
@@ -48,8 +54,29 @@ public:
 private:
     const int open_tries_ = 5;
     const unsigned int open_interval_ = 10;
+    file_options options_;
     std::FILE *fd_{nullptr};
     filename_t filename_;
+    std::chrono::steady_clock::time_point last_sync_;
+
+    // fd and io_uring backends: the file, and the data not written to it yet
+    int raw_fd_{-1};
+    memory_buf_t buffer_;
+    // io_uring backend: the buffer being written by the kernel.
+    // declared first, so that the writer (which waits for the write) is destroyed before it.
+    memory_buf_t in_flight_;
+    std::unique_ptr<io_uring_writer> uring_;
+
+    bool open_(const filename_t &fname, bool truncate);
+    void write_buffer_(memory_buf_t &buf, const char *data, size_t size);
+    static void drop_front_(memory_buf_t &buf, size_t n);
+    // write the data, in one call for both buffers. returns 0, or the errno of the failed write,
+    // and the number of bytes written before it.
+    int write_fd_(const char *data1, size_t size1, const char *data2, size_t size2, size_t &written_total);
+    void submit_buffer_();
+    void wait_in_flight_();
+    void sync_();
+    void sync_if_due_();
 };
 } // namespace details
 } // namespace spdlog
@@ -0,0 +1,177 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// streaming gzip compression (requires zlib), used by gzip_file_sink and by
+// rotating_file_sink to compress rotated files.
+//
+// the output is a sequence of gzip members, which gzip, zcat and zlib decode
+// as a single stream. each member can also be decoded on its own, so a reader
+// can start from any member (they start with the bytes 1f 8b 08), and a file
+// cut short by a crash is readable up to its last complete member.
+#include <spdlog/common.h>
+#include <spdlog/details/os.h>
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <limits>
+
+// default number of uncompressed bytes per gzip member
+#ifndef SPDLOG_GZIP_MEMBER_SIZE
+#    define SPDLOG_GZIP_MEMBER_SIZE (1024 * 1024)
+#endif
+
+namespace spdlog {
+namespace details {
+
+class gzip_writer
+{
+public:
+    explicit gzip_writer(int level = Z_DEFAULT_COMPRESSION)
+    {
+        // 16 + MAX_WBITS: gzip header and trailer instead of the zlib ones
+        if (deflateInit2(&stream_, level, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+            throw_spdlog_ex("gzip_writer: deflateInit2 failed");
+        }
+    }
+
+    gzip_writer(const gzip_writer &) = delete;
+    gzip_writer &operator=(const gzip_writer &) = delete;
+
+    ~gzip_writer()
+    {
+        deflateEnd(&stream_);
+    }
+
+    // compress the data into the current member, appending the output (if any) to dest.
+    void write(const char *data, size_t n, memory_buf_t &dest)
+    {
+        while (n > 0)
+        {
+            const auto chunk = static_cast<uInt>((std::min)(n, static_cast<size_t>((std::numeric_limits<uInt>::max)())));
+            stream_.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+            stream_.avail_in = chunk;
+            deflate_(Z_NO_FLUSH, dest);
+            data += chunk;
+            n -= chunk;
+            member_bytes_ += chunk;
+        }
+    }
+
+    // make what was written so far decodable, without ending the member.
+    void sync(memory_buf_t &dest)
+    {
+        if (member_bytes_ > 0)
+        {
+            deflate_(Z_SYNC_FLUSH, dest);
+        }
+    }
+
+    // end the current member. the next write starts a new one.
+    void finish_member(memory_buf_t &dest)
+    {
+        if (member_bytes_ > 0)
+        {
+            deflate_(Z_FINISH, dest);
+            deflateReset(&stream_);
+            member_bytes_ = 0;
+        }
+    }
+
+    // drop the current member, e.g. once its output could not be written. the next write starts a new one.
+    void abandon_member()
+    {
+        deflateReset(&stream_);
+        member_bytes_ = 0;
+    }
+
+    // uncompressed bytes written to the current member
+    size_t member_bytes() const
+    {
+        return member_bytes_;
+    }
+
+private:
+    z_stream stream_{};
+    size_t member_bytes_{0};
+
+    void deflate_(int flush, memory_buf_t &dest)
+    {
+        const size_t out_chunk = 16 * 1024;
+        for (;;)
+        {
+            const size_t old_size = dest.size();
+            dest.resize(old_size + out_chunk);
+            stream_.next_out = reinterpret_cast<Bytef *>(dest.data() + old_size);
+            stream_.avail_out = static_cast<uInt>(out_chunk);
+            const int rv = deflate(&stream_, flush);
+            dest.resize(old_size + out_chunk - stream_.avail_out);
+            if (rv == Z_STREAM_ERROR)
+            {
+                throw_spdlog_ex("gzip_writer: deflate failed");
+            }
+            // done once deflate had room to spare (or, when finishing, once the member ended)
+            if (flush == Z_FINISH ? rv == Z_STREAM_END : (stream_.avail_out != 0 && stream_.avail_in == 0))
+            {
+                return;
+            }
+        }
+    }
+};
+
+// compress the src file into dst, in members of member_size uncompressed bytes.
+inline void gzip_file(const filename_t &src, const filename_t &dst, size_t member_size, int level = Z_DEFAULT_COMPRESSION)
+{
+    std::FILE *in;
+    if (os::fopen_s(&in, src, SPDLOG_FILENAME_T("rb")))
+    {
+        throw_spdlog_ex("gzip_file: failed opening " + os::filename_to_str(src), errno);
+    }
+    std::FILE *out;
+    if (os::fopen_s(&out, dst, SPDLOG_FILENAME_T("wb")))
+    {
+        std::fclose(in);
+        throw_spdlog_ex("gzip_file: failed opening " + os::filename_to_str(dst), errno);
+    }
+
+    gzip_writer writer(level);
+    memory_buf_t compressed;
+    char block[64 * 1024];
+    bool failed = false;
+    for (;;)
+    {
+        const size_t n = std::fread(block, 1, sizeof(block), in);
+        if (n > 0)
+        {
+            writer.write(block, n, compressed);
+        }
+        if (n < sizeof(block) || writer.member_bytes() >= member_size)
+        {
+            writer.finish_member(compressed);
+        }
+        if (compressed.size() > 0 && std::fwrite(compressed.data(), 1, compressed.size(), out) != compressed.size())
+        {
+            failed = true;
+            break;
+        }
+        compressed.clear();
+        if (n < sizeof(block))
+        {
+            failed = std::ferror(in) != 0;
+            break;
+        }
+    }
+    std::fclose(in);
+    if (std::fclose(out) != 0 || failed)
+    {
+        throw_spdlog_ex("gzip_file: failed compressing " + os::filename_to_str(src) + " to " + os::filename_to_str(dst), errno);
+    }
+}
+
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,235 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// writes through io_uring, for file_helper's io_uring backend.
+// one write is in flight at a time: file_helper fills its next buffer while
+// the kernel writes the previous one, and waits for it before the next submit.
+// it uses the system calls directly, so it does not depend on liburing.
+// elsewhere than on linux, create() always returns nullptr.
+#include <spdlog/common.h>
+
+#ifdef __linux__
+#    if defined(__has_include)
+#        if __has_include(<linux/io_uring.h>)
+#            include <linux/io_uring.h>
+#        endif
+#    endif
+#    include <sys/mman.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <memory>
+
+// IORING_OP_WRITE and writes at the current position need linux 5.6
+#if defined(IORING_FEAT_RW_CUR_POS) && defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#    define SPDLOG_IO_URING_AVAILABLE
+#endif
+
+namespace spdlog {
+namespace details {
+
+class io_uring_writer
+{
+public:
+    // nullptr if io_uring is not available, in the kernel (too old, or disabled
+    // e.g. by a seccomp filter) or in the headers spdlog was built with.
+    static std::unique_ptr<io_uring_writer> create()
+    {
+        std::unique_ptr<io_uring_writer> writer(new io_uring_writer());
+        if (!writer->setup_())
+        {
+            writer.reset();
+        }
+        return writer;
+    }
+
+    io_uring_writer(const io_uring_writer &) = delete;
+    io_uring_writer &operator=(const io_uring_writer &) = delete;
+
+    ~io_uring_writer()
+    {
+#ifdef SPDLOG_IO_URING_AVAILABLE
+        if (pending_)
+        {
+            (void)wait();
+        }
+        if (sqes_ != nullptr)
+        {
+            ::munmap(sqes_, sqes_size_);
+        }
+        if (cq_ring_ != nullptr && cq_ring_ != sq_ring_)
+        {
+            ::munmap(cq_ring_, cq_ring_size_);
+        }
+        if (sq_ring_ != nullptr)
+        {
+            ::munmap(sq_ring_, sq_ring_size_);
+        }
+        if (ring_fd_ != -1)
+        {
+            ::close(ring_fd_);
+        }
+#endif
+    }
+
+    // start writing the data at the current position of the fd (its end, with O_APPEND).
+    // the data must stay valid until wait() returns. false if it could not be submitted.
+    bool submit(int fd, const char *data, size_t n)
+    {
+#ifdef SPDLOG_IO_URING_AVAILABLE
+        unsigned tail = *sq_tail_;
+        unsigned index = tail & *sq_mask_;
+        io_uring_sqe *sqe = &sqes_[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_WRITE;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<__u64>(data);
+        // a short write is completed by the caller
+        sqe->len = static_cast<__u32>(n < INT_MAX ? n : INT_MAX);
+        sqe->off = static_cast<__u64>(-1);
+        sq_array_[index] = index;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+
+        long rv;
+        do
+        {
+            rv = ::syscall(__NR_io_uring_enter, ring_fd_, 1, 0, 0, nullptr, 0);
+        } while (rv < 0 && errno == EINTR);
+        if (rv != 1)
+        {
+            // take the entry back, it was not consumed
+            __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+            return false;
+        }
+        pending_ = true;
+        return true;
+#else
+        (void)fd;
+        (void)data;
+        (void)n;
+        return false;
+#endif
+    }
+
+    // wait for the write in flight. returns the number of bytes written, or -errno.
+    // pending() is still true if the wait itself failed: the write may still be running,
+    // and its data must stay valid until a later wait() returns with pending() false.
+    int wait()
+    {
+#ifdef SPDLOG_IO_URING_AVAILABLE
+        for (;;)
+        {
+            unsigned head = *cq_head_;
+            if (head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE))
+            {
+                int res = cqes_[head & *cq_mask_].res;
+                __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+                pending_ = false;
+                return res;
+            }
+            long rv = ::syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (rv < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+            {
+                return -errno;
+            }
+        }
+#else
+        return -ENOSYS;
+#endif
+    }
+
+    bool pending() const
+    {
+        return pending_;
+    }
+
+private:
+    bool pending_{false};
+#ifdef SPDLOG_IO_URING_AVAILABLE
+    int ring_fd_{-1};
+    void *sq_ring_{nullptr};
+    void *cq_ring_{nullptr};
+    size_t sq_ring_size_{0};
+    size_t cq_ring_size_{0};
+    io_uring_sqe *sqes_{nullptr};
+    size_t sqes_size_{0};
+    unsigned *sq_tail_{nullptr};
+    unsigned *sq_mask_{nullptr};
+    unsigned *sq_array_{nullptr};
+    unsigned *cq_head_{nullptr};
+    unsigned *cq_tail_{nullptr};
+    unsigned *cq_mask_{nullptr};
+    io_uring_cqe *cqes_{nullptr};
+#endif
+
+    io_uring_writer() = default;
+
+    bool setup_()
+    {
+#ifdef SPDLOG_IO_URING_AVAILABLE
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ring_fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, 2, &params));
+        if (ring_fd_ < 0)
+        {
+            ring_fd_ = -1;
+            return false;
+        }
+        if ((params.features & IORING_FEAT_RW_CUR_POS) == 0)
+        {
+            return false;
+        }
+
+        sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap)
+        {
+            sq_ring_size_ = cq_ring_size_ = (std::max)(sq_ring_size_, cq_ring_size_);
+        }
+        sq_ring_ = map_(sq_ring_size_, IORING_OFF_SQ_RING);
+        if (sq_ring_ == nullptr)
+        {
+            return false;
+        }
+        cq_ring_ = single_mmap ? sq_ring_ : map_(cq_ring_size_, IORING_OFF_CQ_RING);
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe *>(map_(sqes_size_, IORING_OFF_SQES));
+        if (cq_ring_ == nullptr || sqes_ == nullptr)
+        {
+            return false;
+        }
+
+        auto *sq = static_cast<char *>(sq_ring_);
+        auto *cq = static_cast<char *>(cq_ring_);
+        sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+#ifdef SPDLOG_IO_URING_AVAILABLE
+    void *map_(size_t size, off_t offset)
+    {
+        void *addr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, offset);
+        return addr == MAP_FAILED ? nullptr : addr;
+    }
+#endif
+};
+
+} // namespace details
+} // namespace spdlog
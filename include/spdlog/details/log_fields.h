@@ -0,0 +1,280 @@
+#pragma once
+
+#include <spdlog/common.h>
+
+#ifdef SPDLOG_JSON_LOGGER
+
+#include <spdlog/details/fmt_helper.h>
+#include <spdlog/field_key.h>
+#include <spdlog/json.h>
+
+#include <cstdint>
+#include <cstring>
+
+// Typed extra fields of a log message, encoded into a flat byte buffer:
+//
+//   [type (1 byte)][key size (uint32)][key][value]
+//
+// where the value is 1 byte for booleans, 8 bytes for numbers, and a uint32
+// size followed by the bytes for strings. Keys and strings are copied, so the
+// encoded fields can outlive the arguments they were built from, and copying
+// them is a plain memcpy.
+//
+// A field_key is encoded as [type | 0x80][key id (uint32)] instead. Its id only
+// has a meaning in the current process, see portable_copy().
+
+namespace spdlog {
+namespace details {
+
+enum class field_type : uint8_t
+{
+    null,
+    boolean,
+    int64,
+    uint64,
+    float64,
+    string
+};
+
+// A decoded field. key and string point into the encoded buffer, or into the
+// field_key table for interned keys, which also have a rendered_key ("key":).
+struct field
+{
+    string_view_t key;
+    string_view_t rendered_key;
+    field_type type;
+    union
+    {
+        bool boolean;
+        int64_t int64;
+        uint64_t uint64;
+        double float64;
+    };
+    string_view_t string;
+};
+
+namespace log_fields {
+
+constexpr uint8_t interned_key_flag = 0x80;
+
+template<typename T>
+inline void append_raw(T value, memory_buf_t &dest)
+{
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    dest.append(bytes, bytes + sizeof(T));
+}
+
+template<typename T>
+inline T read_raw(const char *&p)
+{
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    p += sizeof(T);
+    return value;
+}
+
+inline void append_string(string_view_t s, memory_buf_t &dest)
+{
+    append_raw(static_cast<uint32_t>(s.size()), dest);
+    fmt_helper::append_string_view(s, dest);
+}
+
+inline string_view_t read_string(const char *&p)
+{
+    auto size = read_raw<uint32_t>(p);
+    string_view_t s(p, size);
+    p += size;
+    return s;
+}
+
+inline void append_key(const field_name &key, field_type type, memory_buf_t &dest)
+{
+    if (key.interned)
+    {
+        dest.push_back(static_cast<char>(static_cast<uint8_t>(type) | interned_key_flag));
+        append_raw(key.id, dest);
+        return;
+    }
+    dest.push_back(static_cast<char>(type));
+    append_string(key.name, dest);
+}
+
+inline void append(const field_name &key, std::nullptr_t, memory_buf_t &dest)
+{
+    append_key(key, field_type::null, dest);
+}
+
+inline void append(const field_name &key, bool value, memory_buf_t &dest)
+{
+    append_key(key, field_type::boolean, dest);
+    dest.push_back(value ? '\1' : '\0');
+}
+
+inline void append(const field_name &key, int64_t value, memory_buf_t &dest)
+{
+    append_key(key, field_type::int64, dest);
+    append_raw(value, dest);
+}
+
+inline void append(const field_name &key, uint64_t value, memory_buf_t &dest)
+{
+    append_key(key, field_type::uint64, dest);
+    append_raw(value, dest);
+}
+
+inline void append(const field_name &key, double value, memory_buf_t &dest)
+{
+    append_key(key, field_type::float64, dest);
+    append_raw(value, dest);
+}
+
+inline void append(const field_name &key, string_view_t value, memory_buf_t &dest)
+{
+    append_key(key, field_type::string, dest);
+    append_string(value, dest);
+}
+
+// decode the field at p and advance p past it.
+inline field read(const char *&p)
+{
+    field f{};
+    const auto type = static_cast<uint8_t>(*p++);
+    f.type = static_cast<field_type>(type & ~interned_key_flag);
+    if (type & interned_key_flag)
+    {
+        const auto &key = field_key_table::instance().get(read_raw<uint32_t>(p));
+        f.key = string_view_t(key.name.data(), key.name.size());
+        f.rendered_key = string_view_t(key.rendered.data(), key.rendered.size());
+    }
+    else
+    {
+        f.key = read_string(p);
+    }
+    switch (f.type)
+    {
+    case field_type::null:
+        break;
+    case field_type::boolean:
+        f.boolean = *p++ != '\0';
+        break;
+    case field_type::int64:
+        f.int64 = read_raw<int64_t>(p);
+        break;
+    case field_type::uint64:
+        f.uint64 = read_raw<uint64_t>(p);
+        break;
+    case field_type::float64:
+        f.float64 = read_raw<double>(p);
+        break;
+    case field_type::string:
+        f.string = read_string(p);
+        break;
+    }
+    return f;
+}
+
+// call fun(field) for each field in the encoded buffer, in insertion order.
+template<typename Fun>
+inline void for_each(string_view_t encoded, Fun fun)
+{
+    const char *p = encoded.data();
+    const char *end = p + encoded.size();
+    while (p < end)
+    {
+        fun(read(p));
+    }
+}
+
+// append the given decoded field, with its key as a plain string.
+inline void append(const field &f, memory_buf_t &dest)
+{
+    switch (f.type)
+    {
+    case field_type::null:
+        append(f.key, nullptr, dest);
+        break;
+    case field_type::boolean:
+        append(f.key, f.boolean, dest);
+        break;
+    case field_type::int64:
+        append(f.key, f.int64, dest);
+        break;
+    case field_type::uint64:
+        append(f.key, f.uint64, dest);
+        break;
+    case field_type::float64:
+        append(f.key, f.float64, dest);
+        break;
+    case field_type::string:
+        append(f.key, f.string, dest);
+        break;
+    }
+}
+
+// copy the encoded fields, replacing interned keys by their names,
+// so that another process can decode them.
+inline void portable_copy(string_view_t encoded, memory_buf_t &dest)
+{
+    const char *p = encoded.data();
+    const char *end = p + encoded.size();
+    while (p < end)
+    {
+        const char *start = p;
+        const bool interned = (static_cast<uint8_t>(*p) & interned_key_flag) != 0;
+        auto f = read(p);
+        if (interned)
+        {
+            append(f, dest);
+        }
+        else
+        {
+            dest.append(start, p);
+        }
+    }
+}
+
+inline bool contains(string_view_t encoded, string_view_t key)
+{
+    const char *p = encoded.data();
+    const char *end = p + encoded.size();
+    while (p < end)
+    {
+        auto f = read(p);
+        if (f.key.size() == key.size() && std::memcmp(f.key.data(), key.data(), key.size()) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// convert the field value to a nlohmann::json value.
+inline nlohmann::json to_json(const field &f)
+{
+    switch (f.type)
+    {
+    case field_type::boolean:
+        return f.boolean;
+    case field_type::int64:
+        return f.int64;
+    case field_type::uint64:
+        return f.uint64;
+    case field_type::float64:
+        return f.float64;
+    case field_type::string:
+        return std::string(f.string.data(), f.string.size());
+    default:
+        return nullptr;
+    }
+}
+
+} // namespace log_fields
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include <spdlog/field_key-inl.h>
+#endif
+
+#endif
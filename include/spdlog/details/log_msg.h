@@ -34,6 +34,8 @@ struct SPDLOG_API log_msg
 
 #ifdef SPDLOG_JSON_LOGGER
     const nlohmann::json *params = nullptr;
+    // typed fields, encoded by details::log_fields
+    string_view_t fields;
 #endif
 };
 } // namespace details
@@ -16,6 +16,7 @@ SPDLOG_INLINE log_msg_buffer::log_msg_buffer(const log_msg &orig_msg)
     buffer.append(logger_name.begin(), logger_name.end());
     buffer.append(payload.begin(), payload.end());
 #ifdef SPDLOG_JSON_LOGGER
+    buffer.append(fields.begin(), fields.end());
     if (params)
     {
         params_buffer = *params;
@@ -30,6 +31,7 @@ SPDLOG_INLINE log_msg_buffer::log_msg_buffer(const log_msg_buffer &other)
     buffer.append(logger_name.begin(), logger_name.end());
     buffer.append(payload.begin(), payload.end());
 #ifdef SPDLOG_JSON_LOGGER
+    buffer.append(fields.begin(), fields.end());
     if (params)
     {
         params_buffer = *params;
@@ -75,11 +77,32 @@ SPDLOG_INLINE log_msg_buffer &log_msg_buffer::operator=(log_msg_buffer &&other)
     return *this;
 }
 
+SPDLOG_INLINE void log_msg_buffer::assign(const log_msg &orig_msg)
+{
+    log_msg::operator=(orig_msg);
+    buffer.clear();
+    buffer.append(logger_name.begin(), logger_name.end());
+    buffer.append(payload.begin(), payload.end());
+#ifdef SPDLOG_JSON_LOGGER
+    buffer.append(fields.begin(), fields.end());
+    if (params)
+    {
+        params_buffer = *params;
+    }
+    else
+    {
+        params_buffer = nullptr;
+    }
+#endif
+    update_string_views();
+}
+
 SPDLOG_INLINE void log_msg_buffer::update_string_views()
 {
     logger_name = string_view_t{buffer.data(), logger_name.size()};
     payload = string_view_t{buffer.data() + logger_name.size(), payload.size()};
 #ifdef SPDLOG_JSON_LOGGER
+    fields = string_view_t{buffer.data() + logger_name.size() + payload.size(), fields.size()};
     if (params)
     {
         params = &params_buffer;
@@ -4,6 +4,9 @@
 #pragma once
 
 #include <spdlog/details/log_msg.h>
+#ifdef SPDLOG_JSON_LOGGER
+#    include <spdlog/details/log_fields.h>
+#endif
 
 namespace spdlog {
 namespace details {
@@ -24,8 +27,31 @@ public:
     log_msg_buffer &operator=(const log_msg_buffer &other);
     log_msg_buffer &operator=(log_msg_buffer &&other) SPDLOG_NOEXCEPT;
 
+    // hold a copy of the given message, reusing the storage of this buffer.
+    void assign(const log_msg &orig_msg);
+
+    // same, but the payload is written by write_payload(memory_buf_t &), which appends it to the buffer
+    // in place. orig_msg must have an empty payload and no fields.
+    template<typename Write>
+    void assign_formatted(const log_msg &orig_msg, Write &&write_payload)
+    {
+        assign(orig_msg);
+        write_payload(buffer);
+        payload = string_view_t{nullptr, buffer.size() - logger_name.size()};
+        update_string_views();
+    }
+
 #ifdef SPDLOG_JSON_LOGGER
     nlohmann::json params_buffer;
+
+    // append a typed field (see log_fields.h). the encoded fields are stored in the buffer after the payload.
+    template<typename T>
+    void add_field(const field_name &key, T value)
+    {
+        log_fields::append(key, value, buffer);
+        fields = string_view_t{nullptr, buffer.size() - logger_name.size() - payload.size()};
+        update_string_views();
+    }
 #endif
 };
 
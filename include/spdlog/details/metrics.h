@@ -0,0 +1,181 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// counters of the async thread pool and of the sinks.
+// they are updated with relaxed atomics, so any thread (e.g. a metrics scraper)
+// can read them at any time without taking the queue or sink mutexes.
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+#    include <intrin.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+// latency histogram with log-linear buckets, as in HdrHistogram.
+// values below 2^sub_bits ns get a bucket each, larger ones are split in
+// 2^sub_bits buckets per power of two, for a relative error below 1/2^sub_bits.
+// values above 2^max_exponent ns (~18 minutes) are counted in the last bucket.
+class latency_histogram
+{
+public:
+    static constexpr unsigned sub_bits = 4;
+    static constexpr unsigned max_exponent = 40;
+    static constexpr size_t bucket_count = static_cast<size_t>(max_exponent - sub_bits + 2) << sub_bits;
+
+    latency_histogram()
+    {
+        for (auto &bucket : buckets_)
+        {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    latency_histogram(const latency_histogram &) = delete;
+    latency_histogram &operator=(const latency_histogram &) = delete;
+
+    void record(uint64_t nanos)
+    {
+        buckets_[bucket_of(nanos)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    template<typename Rep, typename Period>
+    void record(std::chrono::duration<Rep, Period> latency)
+    {
+        auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count();
+        record(nanos > 0 ? static_cast<uint64_t>(nanos) : 0);
+    }
+
+    uint64_t count() const
+    {
+        uint64_t total = 0;
+        for (auto &bucket : buckets_)
+        {
+            total += bucket.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    // the value (in ns) below which the given fraction of the recorded values are, e.g. 0.99.
+    // returned as the upper bound of its bucket. 0 if nothing was recorded.
+    uint64_t percentile(double fraction) const
+    {
+        uint64_t counts[bucket_count];
+        uint64_t total = 0;
+        for (size_t i = 0; i < bucket_count; i++)
+        {
+            counts[i] = buckets_[i].load(std::memory_order_relaxed);
+            total += counts[i];
+        }
+        if (total == 0)
+        {
+            return 0;
+        }
+        auto rank = static_cast<uint64_t>(fraction * static_cast<double>(total));
+        rank = rank < 1 ? 1 : (rank > total ? total : rank);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < bucket_count; i++)
+        {
+            seen += counts[i];
+            if (seen >= rank)
+            {
+                return upper_bound_of(i);
+            }
+        }
+        return upper_bound_of(bucket_count - 1);
+    }
+
+    static size_t bucket_of(uint64_t nanos)
+    {
+        if (nanos < (uint64_t{1} << sub_bits))
+        {
+            return static_cast<size_t>(nanos);
+        }
+        unsigned exponent = highest_bit(nanos);
+        if (exponent > max_exponent)
+        {
+            return bucket_count - 1;
+        }
+        auto sub = static_cast<size_t>(nanos >> (exponent - sub_bits)) & ((size_t{1} << sub_bits) - 1);
+        return (static_cast<size_t>(exponent - sub_bits + 1) << sub_bits) + sub;
+    }
+
+    static uint64_t upper_bound_of(size_t bucket)
+    {
+        if (bucket < (size_t{1} << sub_bits))
+        {
+            return bucket;
+        }
+        auto exponent = static_cast<unsigned>(bucket >> sub_bits) + sub_bits - 1;
+        auto sub = static_cast<uint64_t>(bucket & ((size_t{1} << sub_bits) - 1));
+        auto width = uint64_t{1} << (exponent - sub_bits);
+        return (((uint64_t{1} << sub_bits) + sub) << (exponent - sub_bits)) + width - 1;
+    }
+
+private:
+    std::atomic<uint64_t> buckets_[bucket_count];
+
+    // index of the highest set bit. value must not be 0.
+    static unsigned highest_bit(uint64_t value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63 - static_cast<unsigned>(__builtin_clzll(value));
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return static_cast<unsigned>(index);
+#else
+        unsigned index = 0;
+        while (value >>= 1)
+        {
+            index++;
+        }
+        return index;
+#endif
+    }
+};
+
+// counters of a sink (see base_sink::metrics()).
+// they are only updated with the sink mutex held, so a load and a store
+// do instead of the dearer atomic increments.
+struct sink_metrics
+{
+    std::atomic<uint64_t> messages{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> flushes{0};
+    // duration of the writes (a message, or a batch of them) and of the flushes
+    latency_histogram write_latency;
+    latency_histogram flush_latency;
+
+    void add_bytes(size_t n)
+    {
+        bytes.store(bytes.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+};
+
+// a snapshot of the counters of an async thread pool (see thread_pool::metrics()).
+// the counters are read one after the other, so they may be slightly off
+// from each other while messages are in flight.
+struct async_metrics
+{
+    // messages put in the queue, including the overrun ones
+    uint64_t enqueued{0};
+    // messages taken from the queue by the worker threads
+    uint64_t dequeued{0};
+    // messages waiting in the queue, and the most there has ever been
+    size_t queue_size{0};
+    size_t max_queue_size{0};
+    // messages lost under async_overflow_policy::overrun_oldest and drop_by_level
+    uint64_t dropped_overrun{0};
+    uint64_t dropped_by_level{0};
+};
+
+} // namespace details
+} // namespace spdlog
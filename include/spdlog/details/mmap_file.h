@@ -0,0 +1,276 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifdef _WIN32
+#    error mmap_file is only available on posix systems
+#endif
+
+// memory mapped file helper for mmap_file_sink.
+// the file grows by preallocated segments, and the current segment is mapped
+// in memory. writes are copies into the mapping, without system calls until
+// the segment is full. the file is truncated to the written size on close.
+// while the file is open, the written size is also kept in a mapped side file
+// (fname + ".size"), so that reopening a file left by a crash resumes after its
+// data, whatever the data ends with. the side file is removed on close.
+#include <spdlog/common.h>
+#include <spdlog/details/os.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+namespace spdlog {
+namespace details {
+
+class mmap_file
+{
+public:
+    static constexpr size_t default_segment_size = 4 * 1024 * 1024;
+
+    mmap_file() = default;
+    mmap_file(const mmap_file &) = delete;
+    mmap_file &operator=(const mmap_file &) = delete;
+
+    ~mmap_file()
+    {
+        close();
+    }
+
+    // open the file and map the segment its data ends in. segment_size is rounded up to the page size.
+    // a file left with its side file (by a crash before close) ends where the side file says,
+    // the rest being unused preallocated space. otherwise the whole file is data.
+    void open(const filename_t &fname, bool truncate = false, size_t segment_size = default_segment_size)
+    {
+        close();
+        filename_ = fname;
+        const size_t page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        segment_size_ = (std::max)((segment_size + page_size - 1) / page_size * page_size, page_size);
+
+        os::create_dir(os::dir_name(fname));
+        int flags = O_RDWR | O_CREAT;
+#ifdef O_CLOEXEC
+        flags |= O_CLOEXEC;
+#endif
+        if (truncate)
+        {
+            flags |= O_TRUNC;
+        }
+        fd_ = ::open(fname.c_str(), flags, 0644);
+        if (fd_ == -1)
+        {
+            throw_spdlog_ex("mmap_file: failed opening file " + os::filename_to_str(fname) + " for writing", errno);
+        }
+        size_known_ = false;
+
+        struct stat st;
+        if (::fstat(fd_, &st) != 0)
+        {
+            fail_("fstat", errno);
+        }
+        auto file_size = (std::min)(static_cast<size_t>(st.st_size), open_size_file_(page_size));
+        size_.store(file_size, std::memory_order_relaxed);
+        *persisted_size_ = file_size;
+        size_known_ = true;
+        map_segment_(file_size / segment_size_ * segment_size_);
+    }
+
+    void reopen(bool truncate)
+    {
+        if (filename_.empty())
+        {
+            throw_spdlog_ex("mmap_file: failed re opening file - was not opened before");
+        }
+        open(filename_, truncate, segment_size_);
+    }
+
+    // ask the kernel to start writing the data back. the data is visible to
+    // readers of the file, and survives a crash of the process, without it.
+    void flush()
+    {
+        if (segment_ != nullptr)
+        {
+            ::msync(segment_, segment_size_, MS_ASYNC);
+        }
+        if (persisted_size_ != nullptr)
+        {
+            ::msync(persisted_size_, size_page_, MS_ASYNC);
+        }
+    }
+
+    // unmap the file, truncate it to the written size and remove the side file. does not throw.
+    void close()
+    {
+        unmap_();
+        if (fd_ != -1)
+        {
+            bool truncated = false;
+            if (size_known_)
+            {
+                truncated = ::ftruncate(fd_, static_cast<off_t>(size_.load(std::memory_order_relaxed))) == 0;
+            }
+            ::close(fd_);
+            fd_ = -1;
+            // without the side file, the whole file is taken as data on the next open
+            if (truncated)
+            {
+                (void)os::remove(size_filename_());
+            }
+        }
+        if (persisted_size_ != nullptr)
+        {
+            ::munmap(persisted_size_, size_page_);
+            persisted_size_ = nullptr;
+        }
+    }
+
+    void write(const char *data, size_t n)
+    {
+        size_t size = size_.load(std::memory_order_relaxed);
+        while (n > 0)
+        {
+            // the segment is full, or a previous mapping failed
+            if (segment_ == nullptr || size - segment_start_ == segment_size_)
+            {
+                map_segment_(size / segment_size_ * segment_size_);
+            }
+            const size_t chunk = (std::min)(n, segment_size_ - (size - segment_start_));
+            std::memcpy(segment_ + (size - segment_start_), data, chunk);
+            data += chunk;
+            n -= chunk;
+            size += chunk;
+            size_.store(size, std::memory_order_release);
+            *persisted_size_ = size;
+        }
+    }
+
+    void write(const memory_buf_t &buf)
+    {
+        write(buf.data(), buf.size());
+    }
+
+    // the written size, which can be read from any thread.
+    size_t size() const
+    {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    const filename_t &filename() const
+    {
+        return filename_;
+    }
+
+private:
+    int fd_{-1};
+    filename_t filename_;
+    size_t segment_size_{default_segment_size};
+    // the mapped segment, and its offset in the file
+    char *segment_{nullptr};
+    size_t segment_start_{0};
+    std::atomic<size_t> size_{0};
+    // false until open() found where the data of the file ends
+    bool size_known_{false};
+    // the written size, mapped from the side file
+    uint64_t *persisted_size_{nullptr};
+    size_t size_page_{0};
+
+    // extend the file to cover the segment at the given offset and map it.
+    // the space is allocated up front, so a full disk fails here instead of
+    // raising SIGBUS on a later write to the mapping.
+    void map_segment_(size_t start)
+    {
+        unmap_();
+#if defined(__linux__) || defined(__FreeBSD__)
+        int rv = ::posix_fallocate(fd_, static_cast<off_t>(start), static_cast<off_t>(segment_size_));
+        if (rv != 0)
+        {
+            fail_("posix_fallocate", rv);
+        }
+#else
+        struct stat st;
+        if (::fstat(fd_, &st) != 0)
+        {
+            fail_("fstat", errno);
+        }
+        if (static_cast<size_t>(st.st_size) < start + segment_size_ && ::ftruncate(fd_, static_cast<off_t>(start + segment_size_)) != 0)
+        {
+            fail_("ftruncate", errno);
+        }
+#endif
+        int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+        // fault the whole segment in now rather than on the first write to each page
+        flags |= MAP_POPULATE;
+#endif
+        void *addr = ::mmap(nullptr, segment_size_, PROT_READ | PROT_WRITE, flags, fd_, static_cast<off_t>(start));
+        if (addr == MAP_FAILED)
+        {
+            fail_("mmap", errno);
+        }
+        segment_ = static_cast<char *>(addr);
+        segment_start_ = start;
+    }
+
+    void unmap_()
+    {
+        if (segment_ != nullptr)
+        {
+            ::munmap(segment_, segment_size_);
+            segment_ = nullptr;
+        }
+    }
+
+    filename_t size_filename_() const
+    {
+        return filename_ + SPDLOG_FILENAME_T(".size");
+    }
+
+    // create or open the side file and map it. return the size it holds if it
+    // was left by a previous run, or SIZE_MAX if there was none.
+    size_t open_size_file_(size_t page_size)
+    {
+        int flags = O_RDWR | O_CREAT;
+#ifdef O_CLOEXEC
+        flags |= O_CLOEXEC;
+#endif
+        int size_fd = ::open(size_filename_().c_str(), flags, 0644);
+        if (size_fd == -1)
+        {
+            fail_("opening the size file", errno);
+        }
+        struct stat st;
+        bool left = ::fstat(size_fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(uint64_t);
+        if (!left && ::ftruncate(size_fd, static_cast<off_t>(page_size)) != 0)
+        {
+            int last_errno = errno;
+            ::close(size_fd);
+            fail_("ftruncate of the size file", last_errno);
+        }
+        void *addr = ::mmap(nullptr, page_size, PROT_READ | PROT_WRITE, MAP_SHARED, size_fd, 0);
+        int last_errno = errno;
+        ::close(size_fd);
+        if (addr == MAP_FAILED)
+        {
+            fail_("mmap of the size file", last_errno);
+        }
+        persisted_size_ = static_cast<uint64_t *>(addr);
+        size_page_ = page_size;
+        return left ? static_cast<size_t>(*persisted_size_) : SIZE_MAX;
+    }
+
+    void fail_(const char *what, int last_errno)
+    {
+        close();
+        throw_spdlog_ex(fmt::format("mmap_file: {} failed on {}", what, os::filename_to_str(filename_)), last_errno);
+    }
+};
+} // namespace details
+} // namespace spdlog
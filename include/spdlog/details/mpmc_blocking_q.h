@@ -9,9 +9,13 @@
 // the queue.
 // dequeue_for(..) - will block until the queue is not empty or timeout have
 // passed.
+// try_dequeue_bulk(..) - will return immediately with the items available.
+// waiting threads sleep or spin depending on the async_wait_strategy.
 
+#include <spdlog/details/async_queue.h>
 #include <spdlog/details/circular_q.h>
 
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
 
@@ -19,108 +23,296 @@ namespace spdlog {
 namespace details {
 
 template<typename T>
-class mpmc_blocking_queue
+class mpmc_blocking_queue : public async_queue<T>
 {
 public:
     using item_type = T;
-    explicit mpmc_blocking_queue(size_t max_items)
-        : q_(max_items)
+    explicit mpmc_blocking_queue(size_t max_items, async_wait_strategy wait_strategy = async_wait_strategy::block)
+        : max_items_(max_items)
+        , wait_strategy_(wait_strategy)
+        , q_(max_items)
     {}
 
 #ifndef __MINGW32__
     // try to enqueue and block if no room left
-    void enqueue(T &&item)
+    void enqueue(T &&item) override
     {
+        bool wake;
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
-            pop_cv_.wait(lock, [this] { return !this->q_.full(); });
-            q_.push_back(std::move(item));
+            wait_(lock, pop_cv_, pop_waiters_, std::chrono::milliseconds::max(), [this] { return !this->full_(); });
+            push_back_(std::move(item));
+            wake = push_waiters_ > 0;
+        }
+        if (wake)
+        {
+            push_cv_.notify_one();
         }
-        push_cv_.notify_one();
     }
 
     // enqueue immediately. overrun oldest message in the queue if no room left.
-    void enqueue_nowait(T &&item)
+    void enqueue_nowait(T &&item) override
     {
+        bool wake;
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
-            q_.push_back(std::move(item));
+            push_back_(std::move(item));
+            wake = push_waiters_ > 0;
+        }
+        if (wake)
+        {
+            push_cv_.notify_one();
         }
-        push_cv_.notify_one();
     }
 
     // try to dequeue item. if no item found. wait upto timeout and try again
     // Return true, if succeeded dequeue item, false otherwise
-    bool dequeue_for(T &popped_item, std::chrono::milliseconds wait_duration)
+    bool dequeue_for(T &popped_item, std::chrono::milliseconds wait_duration) override
     {
+        bool wake;
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
-            if (!push_cv_.wait_for(lock, wait_duration, [this] { return !this->q_.empty(); }))
+            if (!wait_(lock, push_cv_, push_waiters_, wait_duration, [this] { return !this->empty_(); }))
             {
                 return false;
             }
             popped_item = std::move(q_.front());
-            q_.pop_front();
+            pop_front_();
+            wake = pop_waiters_ > 0;
+        }
+        if (wake)
+        {
+            pop_cv_.notify_one();
         }
-        pop_cv_.notify_one();
         return true;
     }
 
+    // dequeue up to max_items at once. wait upto timeout for the first one.
+    // Return the number of dequeued items
+    size_t dequeue_bulk_for(T *popped_items, size_t max_items, std::chrono::milliseconds wait_duration) override
+    {
+        size_t n = 0;
+        bool wake;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            if (!wait_(lock, push_cv_, push_waiters_, wait_duration, [this] { return !this->empty_(); }))
+            {
+                return 0;
+            }
+            while (n < max_items && !q_.empty())
+            {
+                popped_items[n++] = std::move(q_.front());
+                pop_front_();
+            }
+            wake = pop_waiters_ > 0;
+        }
+        if (wake)
+        {
+            pop_cv_.notify_all();
+        }
+        return n;
+    }
+
+    // dequeue up to max_items at once without waiting.
+    // Return the number of dequeued items
+    size_t try_dequeue_bulk(T *popped_items, size_t max_items) override
+    {
+        size_t n = 0;
+        bool wake;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            while (n < max_items && !q_.empty())
+            {
+                popped_items[n++] = std::move(q_.front());
+                pop_front_();
+            }
+            wake = n > 0 && pop_waiters_ > 0;
+        }
+        if (wake)
+        {
+            pop_cv_.notify_all();
+        }
+        return n;
+    }
+
 #else
     // apparently mingw deadlocks if the mutex is released before cv.notify_one(),
     // so release the mutex at the very end each function.
 
     // try to enqueue and block if no room left
-    void enqueue(T &&item)
+    void enqueue(T &&item) override
     {
         std::unique_lock<std::mutex> lock(queue_mutex_);
-        pop_cv_.wait(lock, [this] { return !this->q_.full(); });
-        q_.push_back(std::move(item));
-        push_cv_.notify_one();
+        wait_(lock, pop_cv_, pop_waiters_, std::chrono::milliseconds::max(), [this] { return !this->full_(); });
+        push_back_(std::move(item));
+        if (push_waiters_ > 0)
+        {
+            push_cv_.notify_one();
+        }
     }
 
     // enqueue immediately. overrun oldest message in the queue if no room left.
-    void enqueue_nowait(T &&item)
+    void enqueue_nowait(T &&item) override
     {
         std::unique_lock<std::mutex> lock(queue_mutex_);
-        q_.push_back(std::move(item));
-        push_cv_.notify_one();
+        push_back_(std::move(item));
+        if (push_waiters_ > 0)
+        {
+            push_cv_.notify_one();
+        }
     }
 
     // try to dequeue item. if no item found. wait upto timeout and try again
     // Return true, if succeeded dequeue item, false otherwise
-    bool dequeue_for(T &popped_item, std::chrono::milliseconds wait_duration)
+    bool dequeue_for(T &popped_item, std::chrono::milliseconds wait_duration) override
     {
         std::unique_lock<std::mutex> lock(queue_mutex_);
-        if (!push_cv_.wait_for(lock, wait_duration, [this] { return !this->q_.empty(); }))
+        if (!wait_(lock, push_cv_, push_waiters_, wait_duration, [this] { return !this->empty_(); }))
         {
             return false;
         }
         popped_item = std::move(q_.front());
-        q_.pop_front();
-        pop_cv_.notify_one();
+        pop_front_();
+        if (pop_waiters_ > 0)
+        {
+            pop_cv_.notify_one();
+        }
         return true;
     }
 
-#endif
-
-    size_t overrun_counter()
+    // dequeue up to max_items at once. wait upto timeout for the first one.
+    // Return the number of dequeued items
+    size_t dequeue_bulk_for(T *popped_items, size_t max_items, std::chrono::milliseconds wait_duration) override
     {
         std::unique_lock<std::mutex> lock(queue_mutex_);
-        return q_.overrun_counter();
+        if (!wait_(lock, push_cv_, push_waiters_, wait_duration, [this] { return !this->empty_(); }))
+        {
+            return 0;
+        }
+        size_t n = 0;
+        while (n < max_items && !q_.empty())
+        {
+            popped_items[n++] = std::move(q_.front());
+            pop_front_();
+        }
+        if (pop_waiters_ > 0)
+        {
+            pop_cv_.notify_all();
+        }
+        return n;
     }
 
-    size_t size()
+    // dequeue up to max_items at once without waiting.
+    // Return the number of dequeued items
+    size_t try_dequeue_bulk(T *popped_items, size_t max_items) override
     {
         std::unique_lock<std::mutex> lock(queue_mutex_);
-        return q_.size();
+        size_t n = 0;
+        while (n < max_items && !q_.empty())
+        {
+            popped_items[n++] = std::move(q_.front());
+            pop_front_();
+        }
+        if (n > 0 && pop_waiters_ > 0)
+        {
+            pop_cv_.notify_all();
+        }
+        return n;
+    }
+
+#endif
+
+    // neither takes the mutex, so they are cheap enough to check before every enqueue
+    // or to poll from a metrics thread
+    size_t overrun_counter() override
+    {
+        return overrun_hint_.load(std::memory_order_relaxed);
+    }
+
+    size_t size() override
+    {
+        return size_hint_.load(std::memory_order_relaxed);
     }
 
 private:
+    const size_t max_items_;
+    const async_wait_strategy wait_strategy_;
     std::mutex queue_mutex_;
     std::condition_variable push_cv_;
     std::condition_variable pop_cv_;
+    // threads sleeping on push_cv_ (consumers) and pop_cv_ (blocked producers).
+    // the other side skips the notification when there are none.
+    int push_waiters_{0};
+    int pop_waiters_{0};
     spdlog::details::circular_q<T> q_;
+    // q_.size() and q_.overrun_counter(), readable without the mutex
+    std::atomic<size_t> size_hint_{0};
+    std::atomic<size_t> overrun_hint_{0};
+
+    bool empty_() const
+    {
+        return size_hint_.load(std::memory_order_relaxed) == 0;
+    }
+
+    bool full_() const
+    {
+        return size_hint_.load(std::memory_order_relaxed) >= max_items_;
+    }
+
+    void push_back_(T &&item)
+    {
+        q_.push_back(std::move(item));
+        size_hint_.store(q_.size(), std::memory_order_relaxed);
+        overrun_hint_.store(q_.overrun_counter(), std::memory_order_relaxed);
+    }
+
+    void pop_front_()
+    {
+        q_.pop_front();
+        size_hint_.store(q_.size(), std::memory_order_relaxed);
+    }
+
+    // wait until pred() holds, with the lock held on return. false if the timeout passed first.
+    // pred() only reads size_hint_, so spinning waiters poll it without taking the lock.
+    template<typename Pred>
+    bool wait_(std::unique_lock<std::mutex> &lock, std::condition_variable &cv, int &waiters, std::chrono::milliseconds wait_duration,
+        Pred pred)
+    {
+        if (pred())
+        {
+            return true;
+        }
+        if (wait_strategy_ == async_wait_strategy::block)
+        {
+            waiters++;
+            bool result = wait_duration == std::chrono::milliseconds::max() ? (cv.wait(lock, pred), true)
+                                                                               : cv.wait_for(lock, wait_duration, pred);
+            waiters--;
+            return result;
+        }
+
+        const auto deadline = wait_duration == std::chrono::milliseconds::max() ? std::chrono::steady_clock::time_point::max()
+                                                                                 : std::chrono::steady_clock::now() + wait_duration;
+        spin_waiter waiter(wait_strategy_);
+        for (;;)
+        {
+            lock.unlock();
+            do
+            {
+                if (std::chrono::steady_clock::now() >= deadline)
+                {
+                    lock.lock();
+                    return pred();
+                }
+                waiter.pause();
+            } while (!pred());
+            lock.lock();
+            if (pred())
+            {
+                return true;
+            }
+        }
+    }
 };
 } // namespace details
 } // namespace spdlog
@@ -0,0 +1,287 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// multi producer-multi consumer bounded lock-free queue (Dmitry Vyukov's design).
+// every slot carries a sequence number telling whether it is ready to be written or
+// read at a given position, so producers and consumers only contend on an atomic
+// position counter instead of a mutex.
+//
+// a consumer finding the queue empty (or a producer finding it full, with the block
+// policy) spins for a while and then sleeps on a condition variable. the other side
+// only takes the mutex to wake it up when someone is actually sleeping. with a
+// spinning async_wait_strategy, waiters keep spinning and never sleep.
+
+#include <spdlog/common.h>
+#include <spdlog/details/async_queue.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace spdlog {
+namespace details {
+
+template<typename T>
+class mpmc_lockfree_queue : public async_queue<T>
+{
+public:
+    using item_type = T;
+    explicit mpmc_lockfree_queue(size_t max_items, async_wait_strategy wait_strategy = async_wait_strategy::block)
+        : capacity_(max_items)
+        , wait_strategy_(wait_strategy)
+        , slots_(new slot[max_items])
+    {
+        if (max_items == 0)
+        {
+            throw_spdlog_ex("mpmc_lockfree_queue: max_items must be greater than 0");
+        }
+        for (size_t i = 0; i < capacity_; i++)
+        {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    mpmc_lockfree_queue(const mpmc_lockfree_queue &) = delete;
+    mpmc_lockfree_queue &operator=(const mpmc_lockfree_queue &) = delete;
+
+    // try to enqueue and block if no room left
+    void enqueue(T &&item) override
+    {
+        if (!try_enqueue_(item))
+        {
+            while (!wait_for_(pop_sleepers_, pop_cv_, std::chrono::seconds(1), [this, &item] { return this->try_enqueue_(item); })) {}
+        }
+        wake_(push_sleepers_, push_cv_);
+    }
+
+    // enqueue immediately. overrun oldest message in the queue if no room left.
+    void enqueue_nowait(T &&item) override
+    {
+        while (!try_enqueue_(item))
+        {
+            T discarded;
+            if (try_dequeue_(discarded))
+            {
+                overrun_counter_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        wake_(push_sleepers_, push_cv_);
+    }
+
+    // try to dequeue item. if no item found. wait upto timeout and try again
+    // Return true, if succeeded dequeue item, false otherwise
+    bool dequeue_for(T &popped_item, std::chrono::milliseconds wait_duration) override
+    {
+        if (!try_dequeue_(popped_item) &&
+            !wait_for_(push_sleepers_, push_cv_, wait_duration, [this, &popped_item] { return this->try_dequeue_(popped_item); }))
+        {
+            return false;
+        }
+        wake_(pop_sleepers_, pop_cv_);
+        return true;
+    }
+
+    // dequeue up to max_items at once. wait upto timeout for the first one.
+    // Return the number of dequeued items
+    size_t dequeue_bulk_for(T *popped_items, size_t max_items, std::chrono::milliseconds wait_duration) override
+    {
+        if (max_items == 0 ||
+            (!try_dequeue_(popped_items[0]) &&
+                !wait_for_(push_sleepers_, push_cv_, wait_duration, [this, popped_items] { return this->try_dequeue_(popped_items[0]); })))
+        {
+            return 0;
+        }
+        size_t n = 1;
+        while (n < max_items && try_dequeue_(popped_items[n]))
+        {
+            n++;
+        }
+        wake_(pop_sleepers_, pop_cv_, n > 1);
+        return n;
+    }
+
+    // dequeue up to max_items at once without waiting.
+    // Return the number of dequeued items
+    size_t try_dequeue_bulk(T *popped_items, size_t max_items) override
+    {
+        size_t n = 0;
+        while (n < max_items && try_dequeue_(popped_items[n]))
+        {
+            n++;
+        }
+        if (n > 0)
+        {
+            wake_(pop_sleepers_, pop_cv_, n > 1);
+        }
+        return n;
+    }
+
+    size_t overrun_counter() override
+    {
+        return overrun_counter_.load(std::memory_order_relaxed);
+    }
+
+    size_t size() override
+    {
+        auto dequeue_pos = dequeue_pos_.load(std::memory_order_acquire);
+        auto enqueue_pos = enqueue_pos_.load(std::memory_order_acquire);
+        if (enqueue_pos <= dequeue_pos)
+        {
+            return 0;
+        }
+        return enqueue_pos - dequeue_pos < capacity_ ? enqueue_pos - dequeue_pos : capacity_;
+    }
+
+private:
+    static constexpr int spin_count = 64;
+    static constexpr size_t cache_line = 64;
+
+    struct slot
+    {
+        std::atomic<size_t> sequence;
+        T item;
+    };
+
+    const size_t capacity_;
+    const async_wait_strategy wait_strategy_;
+    std::unique_ptr<slot[]> slots_;
+
+    // keep the producer and consumer positions on separate cache lines
+    char pad0_[cache_line];
+    std::atomic<size_t> enqueue_pos_{0};
+    char pad1_[cache_line - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> dequeue_pos_{0};
+    char pad2_[cache_line - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> overrun_counter_{0};
+
+    std::atomic<int> push_sleepers_{0};
+    std::atomic<int> pop_sleepers_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable push_cv_;
+    std::condition_variable pop_cv_;
+
+    // move item into the queue. item is left untouched if the queue is full.
+    bool try_enqueue_(T &item)
+    {
+        slot *s;
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            s = &slots_[pos % capacity_];
+            auto seq = s->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        s->item = std::move(item);
+        s->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_dequeue_(T &popped_item)
+    {
+        slot *s;
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            s = &slots_[pos % capacity_];
+            auto seq = s->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0)
+            {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        popped_item = std::move(s->item);
+        s->sequence.store(pos + capacity_, std::memory_order_release);
+        return true;
+    }
+
+    // spin, then sleep on cv until pred() succeeds or the timeout has passed.
+    // the spinning strategies never sleep, so the other side never has to wake them.
+    template<typename Pred>
+    bool wait_for_(std::atomic<int> &sleepers, std::condition_variable &cv, std::chrono::milliseconds wait_duration, Pred pred)
+    {
+        if (wait_strategy_ != async_wait_strategy::block)
+        {
+            const auto deadline = std::chrono::steady_clock::now() + wait_duration;
+            spin_waiter waiter(wait_strategy_);
+            while (!pred())
+            {
+                if (std::chrono::steady_clock::now() >= deadline)
+                {
+                    return false;
+                }
+                waiter.pause();
+            }
+            return true;
+        }
+
+        for (int i = 0; i < spin_count; i++)
+        {
+            std::this_thread::yield();
+            if (pred())
+            {
+                return true;
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        sleepers.fetch_add(1, std::memory_order_relaxed);
+        // pairs with the fence in wake_(): either pred() sees the new item/room,
+        // or the other side sees the sleeper and notifies under the mutex.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool result = cv.wait_for(lock, wait_duration, pred);
+        sleepers.fetch_sub(1, std::memory_order_relaxed);
+        return result;
+    }
+
+    void wake_(std::atomic<int> &sleepers, std::condition_variable &cv, bool all = false)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers.load(std::memory_order_relaxed) > 0)
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            if (all)
+            {
+                cv.notify_all();
+            }
+            else
+            {
+                cv.notify_one();
+            }
+        }
+    }
+};
+
+} // namespace details
+} // namespace spdlog
@@ -39,6 +39,7 @@
 
 #else // unix
 
+#    include <dirent.h> // for opendir/readdir
 #    include <fcntl.h>
 #    include <unistd.h>
 
@@ -576,6 +577,53 @@ SPDLOG_INLINE filename_t dir_name(filename_t path)
     return pos != filename_t::npos ? path.substr(0, pos) : filename_t{};
 }
 
+SPDLOG_INLINE std::vector<filename_t> dir_entries(const filename_t &path)
+{
+    std::vector<filename_t> entries;
+#ifdef _WIN32
+#    ifdef SPDLOG_WCHAR_FILENAMES
+    WIN32_FIND_DATAW data;
+    HANDLE find = ::FindFirstFileW((path + L"\\*").c_str(), &data);
+#    else
+    WIN32_FIND_DATAA data;
+    HANDLE find = ::FindFirstFileA((path + "\\*").c_str(), &data);
+#    endif
+    if (find == INVALID_HANDLE_VALUE)
+    {
+        return entries;
+    }
+    do
+    {
+        filename_t name = data.cFileName;
+        if (name != SPDLOG_FILENAME_T(".") && name != SPDLOG_FILENAME_T(".."))
+        {
+            entries.push_back(std::move(name));
+        }
+#    ifdef SPDLOG_WCHAR_FILENAMES
+    } while (::FindNextFileW(find, &data));
+#    else
+    } while (::FindNextFileA(find, &data));
+#    endif
+    ::FindClose(find);
+#else
+    DIR *dir = ::opendir(path.c_str());
+    if (dir == nullptr)
+    {
+        return entries;
+    }
+    while (auto *entry = ::readdir(dir))
+    {
+        filename_t name = entry->d_name;
+        if (name != "." && name != "..")
+        {
+            entries.push_back(std::move(name));
+        }
+    }
+    ::closedir(dir);
+#endif
+    return entries;
+}
+
 std::string SPDLOG_INLINE getenv(const char *field)
 {
 
@@ -5,6 +5,7 @@
 
 #include <spdlog/common.h>
 #include <ctime> // std::time_t
+#include <vector>
 
 namespace spdlog {
 namespace details {
@@ -105,6 +106,10 @@ SPDLOG_API filename_t dir_name(filename_t path);
 // Return true if succeeded or if this dir already exists.
 SPDLOG_API bool create_dir(filename_t path);
 
+// Return the names of the entries of the given directory, without "." and "..".
+// Empty if the directory does not exist or cannot be read.
+SPDLOG_API std::vector<filename_t> dir_entries(const filename_t &path);
+
 // non thread safe, cross platform getenv/getenv_s
 // return empty string if field not found
 SPDLOG_API std::string getenv(const char *field);
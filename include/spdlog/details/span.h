@@ -0,0 +1,62 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <cstddef>
+
+namespace spdlog {
+namespace details {
+
+// non owning view of a contiguous sequence (a subset of c++20 std::span).
+template<typename T>
+class span
+{
+public:
+    using element_type = T;
+    using iterator = T *;
+
+    span() = default;
+
+    span(T *data, size_t size)
+        : data_(data)
+        , size_(size)
+    {}
+
+    T *data() const
+    {
+        return data_;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    T &operator[](size_t i) const
+    {
+        return data_[i];
+    }
+
+    T *begin() const
+    {
+        return data_;
+    }
+
+    T *end() const
+    {
+        return data_ + size_;
+    }
+
+private:
+    T *data_ = nullptr;
+    size_t size_ = 0;
+};
+
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,82 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/task_worker.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE task_worker::task_worker()
+    : worker_thread_([this] { loop_(); })
+{}
+
+SPDLOG_INLINE task_worker::~task_worker()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        active_ = false;
+    }
+    cv_.notify_one();
+    worker_thread_.join();
+}
+
+SPDLOG_INLINE void task_worker::post(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+}
+
+SPDLOG_INLINE std::string task_worker::take_error()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string error;
+    error.swap(error_);
+    return error;
+}
+
+SPDLOG_INLINE void task_worker::loop_()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;)
+    {
+        cv_.wait(lock, [this] { return !tasks_.empty() || !active_; });
+        if (tasks_.empty())
+        {
+            return; // active_ == false and nothing left to run
+        }
+
+        auto task = std::move(tasks_.front());
+        tasks_.pop_front();
+        lock.unlock();
+        std::string error;
+        SPDLOG_TRY
+        {
+            task();
+        }
+#ifndef SPDLOG_NO_EXCEPTIONS
+        catch (const std::exception &ex)
+        {
+            error = ex.what();
+        }
+        catch (...)
+        {
+            error = "unknown exception in task_worker";
+        }
+#endif
+        lock.lock();
+        if (error_.empty())
+        {
+            error_ = std::move(error);
+        }
+    }
+}
+
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,55 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// task worker thread - runs the posted tasks one after the other, in order.
+// used by sinks to move slow file system work (renames, deletes) off the logging threads.
+//
+// RAII over the owned thread:
+//    creates the thread on construction.
+//    runs the remaining tasks, then joins the thread on destruction.
+
+#include <spdlog/common.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace spdlog {
+namespace details {
+
+class SPDLOG_API task_worker
+{
+public:
+    task_worker();
+    task_worker(const task_worker &) = delete;
+    task_worker &operator=(const task_worker &) = delete;
+    // run the remaining tasks, then stop the worker thread and join it
+    ~task_worker();
+
+    void post(std::function<void()> task);
+
+    // the error of the first task that threw since the last call, or an empty string.
+    // tasks run on their own thread, so their owner reports the errors from its own calls.
+    std::string take_error();
+
+private:
+    bool active_{true};
+    std::deque<std::function<void()>> tasks_;
+    std::string error_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread worker_thread_;
+
+    void loop_();
+};
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "task_worker-inl.h"
+#endif
@@ -8,30 +8,67 @@
 #endif
 
 #include <spdlog/common.h>
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <limits>
 
 namespace spdlog {
 namespace details {
 
-SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items, size_t threads_n, std::function<void()> on_thread_start)
-    : q_(q_max_items)
+SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items, size_t threads_n, std::function<void()> on_thread_start,
+    async_queue_type queue_type, async_pool_mode pool_mode, async_wait_strategy wait_strategy)
+    : wait_strategy_(wait_strategy)
+    , queue_capacity_(q_max_items)
 {
     if (threads_n == 0 || threads_n > 1000)
     {
         throw_spdlog_ex("spdlog::thread_pool(): invalid threads_n param (valid "
                         "range is 1-1000)");
     }
+
+    if (pool_mode == async_pool_mode::sharded)
+    {
+        const size_t shards_n = threads_n * SPDLOG_ASYNC_SHARDS_PER_THREAD;
+        queue_capacity_ = (std::max)(q_max_items / shards_n, size_t{1});
+        for (size_t i = 0; i < shards_n; i++)
+        {
+            shards_.emplace_back(details::make_unique<shard>());
+            shards_.back()->q = make_queue_(queue_capacity_, queue_type);
+        }
+    }
+    else
+    {
+        q_ = make_queue_(q_max_items, queue_type);
+    }
+
+    for (int i = 0; i < level::n_levels; i++)
+    {
+        drop_watermarks_[i].store((std::numeric_limits<size_t>::max)(), std::memory_order_relaxed);
+    }
+    set_drop_watermark(level::trace, 0.5);
+    set_drop_watermark(level::debug, 0.5);
+    set_drop_watermark(level::info, 0.75);
+
     for (size_t i = 0; i < threads_n; i++)
     {
-        threads_.emplace_back([this, on_thread_start] {
+        threads_.emplace_back([this, on_thread_start, i] {
             on_thread_start();
-            this->thread_pool::worker_loop_();
+            if (this->shards_.empty())
+            {
+                this->thread_pool::worker_loop_();
+            }
+            else
+            {
+                this->thread_pool::sharded_worker_loop_(i);
+            }
         });
     }
 }
 
-SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items, size_t threads_n)
-    : thread_pool(q_max_items, threads_n, [] {})
+SPDLOG_INLINE thread_pool::thread_pool(
+    size_t q_max_items, size_t threads_n, async_queue_type queue_type, async_pool_mode pool_mode, async_wait_strategy wait_strategy)
+    : thread_pool(q_max_items, threads_n, [] {}, queue_type, pool_mode, wait_strategy)
 {}
 
 // message all threads to terminate gracefully join them
@@ -39,9 +76,19 @@ SPDLOG_INLINE thread_pool::~thread_pool()
 {
     SPDLOG_TRY
     {
-        for (size_t i = 0; i < threads_.size(); i++)
+        if (shards_.empty())
+        {
+            for (size_t i = 0; i < threads_.size(); i++)
+            {
+                post_async_msg_(async_msg(async_msg_type::terminate), async_overflow_policy::block);
+            }
+        }
+        else
         {
-            post_async_msg_(async_msg(async_msg_type::terminate), async_overflow_policy::block);
+            // workers exit once every shard is empty
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            stopping_.store(true);
+            wake_cv_.notify_all();
         }
 
         for (auto &t : threads_)
@@ -54,10 +101,24 @@ SPDLOG_INLINE thread_pool::~thread_pool()
 
 void SPDLOG_INLINE thread_pool::post_log(async_logger_ptr &&worker_ptr, const details::log_msg &msg, async_overflow_policy overflow_policy)
 {
+    if (drop_(*worker_ptr, msg.level, overflow_policy))
+    {
+        return;
+    }
     async_msg async_m(std::move(worker_ptr), async_msg_type::log, msg);
     post_async_msg_(std::move(async_m), overflow_policy);
 }
 
+void SPDLOG_INLINE thread_pool::post_log(async_logger_ptr &&worker_ptr, details::log_msg_buffer &&msg, async_overflow_policy overflow_policy)
+{
+    if (drop_(*worker_ptr, msg.level, overflow_policy))
+    {
+        return;
+    }
+    async_msg async_m(std::move(worker_ptr), async_msg_type::log, std::move(msg));
+    post_async_msg_(std::move(async_m), overflow_policy);
+}
+
 void SPDLOG_INLINE thread_pool::post_flush(async_logger_ptr &&worker_ptr, async_overflow_policy overflow_policy)
 {
     post_async_msg_(async_msg(std::move(worker_ptr), async_msg_type::flush), overflow_policy);
@@ -65,64 +126,293 @@ void SPDLOG_INLINE thread_pool::post_flush(async_logger_ptr &&worker_ptr, async_
 
 size_t SPDLOG_INLINE thread_pool::overrun_counter()
 {
-    return q_.overrun_counter();
+    if (shards_.empty())
+    {
+        return q_->overrun_counter();
+    }
+    size_t counter = 0;
+    for (auto &s : shards_)
+    {
+        counter += s->q->overrun_counter();
+    }
+    return counter;
 }
 
 size_t SPDLOG_INLINE thread_pool::queue_size()
 {
-    return q_.size();
+    if (shards_.empty())
+    {
+        return q_->size();
+    }
+    size_t size = 0;
+    for (auto &s : shards_)
+    {
+        size += s->q->size();
+    }
+    return size;
+}
+
+async_metrics SPDLOG_INLINE thread_pool::metrics()
+{
+    async_metrics m;
+    m.dequeued = dequeued_.load(std::memory_order_relaxed);
+    m.queue_size = queue_size();
+    m.max_queue_size = (std::max)(max_queue_size_.load(std::memory_order_relaxed), m.queue_size);
+    m.dropped_overrun = overrun_counter();
+    m.dropped_by_level = dropped_by_level_.load(std::memory_order_relaxed);
+    // counting on the producer side would make them all write the same cache line
+    m.enqueued = m.dequeued + m.queue_size + m.dropped_overrun;
+    return m;
+}
+
+void SPDLOG_INLINE thread_pool::set_drop_watermark(level::level_enum lvl, double fill_ratio)
+{
+    auto watermark = fill_ratio > 1.0 ? (std::numeric_limits<size_t>::max)()
+                                      : static_cast<size_t>(fill_ratio * static_cast<double>(queue_capacity_));
+    drop_watermarks_[lvl].store(watermark, std::memory_order_relaxed);
+}
+
+std::unique_ptr<thread_pool::q_type> SPDLOG_INLINE thread_pool::make_queue_(size_t q_max_items, async_queue_type queue_type)
+{
+    if (queue_type == async_queue_type::lockfree)
+    {
+        return details::make_unique<mpmc_lockfree_queue<item_type>>(q_max_items, wait_strategy_);
+    }
+    return details::make_unique<mpmc_blocking_queue<item_type>>(q_max_items, wait_strategy_);
+}
+
+SPDLOG_INLINE thread_pool::q_type &thread_pool::queue_of_(const async_logger *logger)
+{
+    return shards_.empty() ? *q_ : *shard_of_(logger).q;
+}
+
+bool SPDLOG_INLINE thread_pool::drop_(async_logger &logger, level::level_enum lvl, async_overflow_policy overflow_policy)
+{
+    if (overflow_policy != async_overflow_policy::drop_by_level ||
+        queue_of_(&logger).size() < drop_watermarks_[lvl].load(std::memory_order_relaxed))
+    {
+        return false;
+    }
+    logger.drops_.add(lvl);
+    dropped_by_level_.fetch_add(1, std::memory_order_relaxed);
+    return true;
 }
 
 void SPDLOG_INLINE thread_pool::post_async_msg_(async_msg &&new_msg, async_overflow_policy overflow_policy)
 {
-    if (overflow_policy == async_overflow_policy::block)
+    shard *target = shards_.empty() ? nullptr : &shard_of_(new_msg.worker_ptr.get());
+    auto &q = target ? *target->q : *q_;
+    if (overflow_policy == async_overflow_policy::overrun_oldest)
     {
-        q_.enqueue(std::move(new_msg));
+        q.enqueue_nowait(std::move(new_msg));
     }
     else
     {
-        q_.enqueue_nowait(std::move(new_msg));
+        q.enqueue(std::move(new_msg));
+    }
+
+    // a worker draining the shard rescans it when done, otherwise wake an idle one.
+    // the queue publishes its size with a relaxed store: the fence orders it before
+    // the load of sleepers_, pairing with the one in sharded_worker_loop_().
+    if (target)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers_.load() > 0 && !target->draining.load())
+        {
+            wake_worker_();
+        }
     }
 }
 
 void SPDLOG_INLINE thread_pool::worker_loop_()
 {
-    while (process_next_msg_()) {}
+    std::vector<async_msg> batch(SPDLOG_ASYNC_BATCH_SIZE);
+    std::vector<const log_msg *> run;
+    run.reserve(batch.size());
+    while (process_next_batch_(batch, run)) {}
 }
 
-// process next message in the queue
+// process the next batch of messages in the queue.
+// consecutive log messages of the same logger are passed to its sinks at once.
 // return true if this thread should still be active (while no terminate msg
 // was received)
-bool SPDLOG_INLINE thread_pool::process_next_msg_()
+bool SPDLOG_INLINE thread_pool::process_next_batch_(std::vector<async_msg> &batch, std::vector<const log_msg *> &run)
 {
-    async_msg incoming_async_msg;
-    bool dequeued = q_.dequeue_for(incoming_async_msg, std::chrono::seconds(10));
-    if (!dequeued)
+    size_t dequeued = q_->dequeue_bulk_for(batch.data(), batch.size(), std::chrono::seconds(10));
+    size_t terminate_msgs = process_batch_(*q_, batch, dequeued, run);
+
+    // every worker thread must get its own terminate message
+    for (size_t i = 1; i < terminate_msgs; i++)
     {
-        return true;
+        post_async_msg_(async_msg(async_msg_type::terminate), async_overflow_policy::block);
     }
+    return terminate_msgs == 0;
+}
 
-    switch (incoming_async_msg.msg_type)
+size_t SPDLOG_INLINE thread_pool::process_batch_(q_type &q, std::vector<async_msg> &batch, size_t n, std::vector<const log_msg *> &run)
+{
+    if (n == 0)
     {
-    case async_msg_type::log: {
-        incoming_async_msg.worker_ptr->backend_sink_it_(incoming_async_msg);
-        return true;
+        return 0;
     }
-    case async_msg_type::flush: {
-        incoming_async_msg.worker_ptr->backend_flush_();
-        return true;
+
+    // the queue held about what is left in it plus what was just taken
+    // (producers may have refilled it since, hence the cap)
+    dequeued_.fetch_add(n, std::memory_order_relaxed);
+    const size_t depth = (std::min)(q.size() + n, queue_capacity_);
+    size_t max_depth = max_queue_size_.load(std::memory_order_relaxed);
+    while (depth > max_depth && !max_queue_size_.compare_exchange_weak(max_depth, depth, std::memory_order_relaxed)) {}
+
+    size_t terminate_msgs = 0;
+    async_logger *run_logger = nullptr;
+    auto sink_run = [&run, &run_logger] {
+        if (!run.empty())
+        {
+            run_logger->backend_sink_batch_({run.data(), run.size()});
+            run.clear();
+        }
+    };
+
+    for (size_t i = 0; i < n; i++)
+    {
+        auto &incoming_async_msg = batch[i];
+        switch (incoming_async_msg.msg_type)
+        {
+        case async_msg_type::log: {
+            if (incoming_async_msg.worker_ptr.get() != run_logger)
+            {
+                sink_run();
+                run_logger = incoming_async_msg.worker_ptr.get();
+            }
+            run.push_back(&incoming_async_msg);
+            break;
+        }
+        case async_msg_type::flush: {
+            sink_run();
+            incoming_async_msg.worker_ptr->backend_flush_();
+            break;
+        }
+
+        case async_msg_type::terminate: {
+            terminate_msgs++;
+            break;
+        }
+
+        default: {
+            assert(false);
+        }
+        }
     }
+    sink_run();
 
-    case async_msg_type::terminate: {
-        return false;
+    // record how long the messages took to reach their sinks, and
+    // release the loggers now rather than when the slots get reused
+    const auto now = log_clock::now();
+    for (size_t i = 0; i < n; i++)
+    {
+        if (batch[i].msg_type == async_msg_type::log)
+        {
+            sink_latency_.record(now - batch[i].time);
+        }
+        batch[i].worker_ptr.reset();
     }
+    return terminate_msgs;
+}
 
-    default: {
-        assert(false);
+SPDLOG_INLINE thread_pool::shard &thread_pool::shard_of_(const async_logger *logger)
+{
+    // fibonacci hashing spreads the (aligned) logger addresses evenly
+    auto h = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(logger)) * UINT64_C(0x9E3779B97F4A7C15);
+    return *shards_[static_cast<size_t>(h >> 32) % shards_.size()];
+}
+
+void SPDLOG_INLINE thread_pool::sharded_worker_loop_(size_t index)
+{
+    std::vector<async_msg> batch(SPDLOG_ASYNC_BATCH_SIZE);
+    std::vector<const log_msg *> run;
+    run.reserve(batch.size());
+    const size_t first = index * SPDLOG_ASYNC_SHARDS_PER_THREAD;
+    spin_waiter waiter(wait_strategy_);
+    for (;;)
+    {
+        // own shards first, then steal from the next workers' ones
+        bool worked = false;
+        for (size_t i = 0; i < shards_.size(); i++)
+        {
+            worked |= drain_shard_(*shards_[(first + i) % shards_.size()], batch, run);
+        }
+        if (worked)
+        {
+            waiter = spin_waiter(wait_strategy_);
+            continue;
+        }
+
+        // spinning workers never sleep, so producers never have to wake them
+        if (wait_strategy_ != async_wait_strategy::block)
+        {
+            if (stopping_.load() && !has_pending_shard_())
+            {
+                return;
+            }
+            waiter.pause();
+            continue;
+        }
+
+        // announce the wait before the last check, so that producers either see
+        // a sleeper to wake, or their message is found by the check.
+        // the queue sizes are relaxed loads, hence the fence (see post_async_msg_()).
+        sleepers_.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!has_pending_shard_())
+        {
+            if (stopping_.load())
+            {
+                sleepers_.fetch_sub(1);
+                return;
+            }
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_cv_.wait_for(lock, std::chrono::seconds(10), [this] { return wakeups_ > 0 || stopping_.load(); });
+            if (wakeups_ > 0)
+            {
+                wakeups_--;
+            }
+        }
+        sleepers_.fetch_sub(1);
     }
+}
+
+bool SPDLOG_INLINE thread_pool::drain_shard_(shard &s, std::vector<async_msg> &batch, std::vector<const log_msg *> &run)
+{
+    if (s.draining.load(std::memory_order_relaxed) || s.draining.exchange(true, std::memory_order_acquire))
+    {
+        return false;
     }
+    size_t dequeued = s.q->try_dequeue_bulk(batch.data(), batch.size());
+    process_batch_(*s.q, batch, dequeued, run);
+    s.draining.store(false);
+    return dequeued > 0;
+}
 
-    return true;
+bool SPDLOG_INLINE thread_pool::has_pending_shard_()
+{
+    for (auto &s : shards_)
+    {
+        if (!s->draining.load() && s->q->size() > 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void SPDLOG_INLINE thread_pool::wake_worker_()
+{
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    if (wakeups_ < static_cast<size_t>(sleepers_.load()))
+    {
+        wakeups_++;
+        wake_cv_.notify_one();
+    }
 }
 
 } // namespace details
@@ -4,15 +4,32 @@
 #pragma once
 
 #include <spdlog/details/log_msg_buffer.h>
+#include <spdlog/details/metrics.h>
 #include <spdlog/details/mpmc_blocking_q.h>
+#include <spdlog/details/mpmc_lockfree_q.h>
 #include <spdlog/details/os.h>
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <vector>
 #include <functional>
 
+// max number of messages a worker thread dequeues and hands to the sinks at once.
+#ifndef SPDLOG_ASYNC_BATCH_SIZE
+#    define SPDLOG_ASYNC_BATCH_SIZE 64
+#endif
+
+// number of queue shards per worker thread with async_pool_mode::sharded.
+// more shards than workers let idle workers take over busy loggers that
+// happen to share a worker.
+#ifndef SPDLOG_ASYNC_SHARDS_PER_THREAD
+#    define SPDLOG_ASYNC_SHARDS_PER_THREAD 4
+#endif
+
 namespace spdlog {
 class async_logger;
 
@@ -67,6 +84,13 @@ struct async_msg : log_msg_buffer
         , worker_ptr{std::move(worker)}
     {}
 
+    // construct from log_msg_buffer with given type, taking over its buffers
+    async_msg(async_logger_ptr &&worker, async_msg_type the_type, details::log_msg_buffer &&m)
+        : log_msg_buffer{std::move(m)}
+        , msg_type{the_type}
+        , worker_ptr{std::move(worker)}
+    {}
+
     async_msg(async_logger_ptr &&worker, async_msg_type the_type)
         : log_msg_buffer{}
         , msg_type{the_type}
@@ -82,10 +106,15 @@ class SPDLOG_API thread_pool
 {
 public:
     using item_type = async_msg;
-    using q_type = details::mpmc_blocking_queue<item_type>;
+    using q_type = details::async_queue<item_type>;
 
-    thread_pool(size_t q_max_items, size_t threads_n, std::function<void()> on_thread_start);
-    thread_pool(size_t q_max_items, size_t threads_n);
+    // with async_pool_mode::sharded, q_max_items is split evenly between the shards.
+    // wait_strategy applies to idle workers and to producers blocked on a full queue.
+    thread_pool(size_t q_max_items, size_t threads_n, std::function<void()> on_thread_start,
+        async_queue_type queue_type = async_queue_type::blocking, async_pool_mode pool_mode = async_pool_mode::shared,
+        async_wait_strategy wait_strategy = async_wait_strategy::block);
+    thread_pool(size_t q_max_items, size_t threads_n, async_queue_type queue_type = async_queue_type::blocking,
+        async_pool_mode pool_mode = async_pool_mode::shared, async_wait_strategy wait_strategy = async_wait_strategy::block);
 
     // message all threads to terminate gracefully join them
     ~thread_pool();
@@ -94,22 +123,84 @@ public:
     thread_pool &operator=(thread_pool &&) = delete;
 
     void post_log(async_logger_ptr &&worker_ptr, const details::log_msg &msg, async_overflow_policy overflow_policy);
+    void post_log(async_logger_ptr &&worker_ptr, details::log_msg_buffer &&msg, async_overflow_policy overflow_policy);
     void post_flush(async_logger_ptr &&worker_ptr, async_overflow_policy overflow_policy);
     size_t overrun_counter();
     size_t queue_size();
 
+    // counters of the pool. lock free, so cheap enough to poll from a metrics thread.
+    async_metrics metrics();
+
+    // time from the creation of each message (log_msg::time) until its sinks returned
+    const latency_histogram &sink_latency() const
+    {
+        return sink_latency_;
+    }
+
+    // with async_overflow_policy::drop_by_level, new messages of the given level are dropped
+    // once the queue holds fill_ratio of its capacity. a ratio above 1 never drops the level,
+    // which waits for room instead. defaults: trace and debug 0.5, info 0.75, warn and above never.
+    void set_drop_watermark(level::level_enum lvl, double fill_ratio);
+
 private:
-    q_type q_;
+    // a queue of the sharded mode. the draining flag makes sure only one
+    // worker at a time takes messages from it.
+    struct shard
+    {
+        std::unique_ptr<q_type> q;
+        std::atomic<bool> draining{false};
+    };
+
+    async_wait_strategy wait_strategy_;
+
+    // capacity of each queue, and the queue size from which each level is dropped
+    size_t queue_capacity_;
+    std::atomic<size_t> drop_watermarks_[level::n_levels];
+
+    // updated by the workers once per batch, and by producers on drops only
+    std::atomic<uint64_t> dequeued_{0};
+    std::atomic<size_t> max_queue_size_{0};
+    std::atomic<uint64_t> dropped_by_level_{0};
+    latency_histogram sink_latency_;
+
+    // the queue of the shared mode
+    std::unique_ptr<q_type> q_;
+
+    // the queues of the sharded mode. worker i owns shards
+    // [i * SPDLOG_ASYNC_SHARDS_PER_THREAD, (i + 1) * SPDLOG_ASYNC_SHARDS_PER_THREAD).
+    std::vector<std::unique_ptr<shard>> shards_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<int> sleepers_{0};
+    size_t wakeups_{0};
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
 
     std::vector<std::thread> threads_;
 
+    std::unique_ptr<q_type> make_queue_(size_t q_max_items, async_queue_type queue_type);
+    q_type &queue_of_(const async_logger *logger);
+    // return true (and count the drop) if the message should be dropped under the overflow policy.
+    bool drop_(async_logger &logger, level::level_enum lvl, async_overflow_policy overflow_policy);
     void post_async_msg_(async_msg &&new_msg, async_overflow_policy overflow_policy);
     void worker_loop_();
 
-    // process next message in the queue
+    // process the next batch of messages in the queue.
+    // consecutive log messages of the same logger are passed to its sinks at once.
     // return true if this thread should still be active (while no terminate msg
     // was received)
-    bool process_next_msg_();
+    bool process_next_batch_(std::vector<async_msg> &batch, std::vector<const log_msg *> &run);
+
+    // pass the first n messages of the batch, just taken from queue q, to their loggers.
+    // return the number of terminate messages.
+    size_t process_batch_(q_type &q, std::vector<async_msg> &batch, size_t n, std::vector<const log_msg *> &run);
+
+    // sharded mode: the shard of a logger, the worker loop, and draining a batch from a shard
+    // unless another worker is already at it. return true if messages were processed.
+    shard &shard_of_(const async_logger *logger);
+    void sharded_worker_loop_(size_t index);
+    bool drain_shard_(shard &s, std::vector<async_msg> &batch, std::vector<const log_msg *> &run);
+    bool has_pending_shard_();
+    void wake_worker_();
 };
 
 } // namespace details
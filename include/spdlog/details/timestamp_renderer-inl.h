@@ -0,0 +1,102 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/timestamp_renderer.h>
+#endif
+
+#include <spdlog/details/fmt_helper.h>
+#include <spdlog/details/os.h>
+
+#include <ctime>
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE timestamp_renderer::timestamp_renderer(timestamp_format format, pattern_time_type time_type)
+    : format_(format)
+    , time_type_(time_type)
+{}
+
+SPDLOG_INLINE timestamp_format timestamp_renderer::format() const
+{
+    return format_;
+}
+
+SPDLOG_INLINE pattern_time_type timestamp_renderer::time_type() const
+{
+    return time_type_;
+}
+
+SPDLOG_INLINE void timestamp_renderer::render(log_clock::time_point tp, memory_buf_t &dest)
+{
+    if (format_ == timestamp_format::epoch_micros)
+    {
+        fmt_helper::append_int(epoch_micros(tp), dest);
+        return;
+    }
+
+    auto secs = std::chrono::duration_cast<std::chrono::seconds>(tp.time_since_epoch());
+    if (secs != cached_secs_)
+    {
+        update_cache_(tp);
+        cached_secs_ = secs;
+    }
+
+    dest.append(prefix_, prefix_ + sizeof(prefix_));
+    if (format_ == timestamp_format::rfc3339_nanos)
+    {
+        fmt_helper::pad9(static_cast<size_t>(fmt_helper::time_fraction<std::chrono::nanoseconds>(tp).count()), dest);
+    }
+    else
+    {
+        fmt_helper::pad3(static_cast<uint32_t>(fmt_helper::time_fraction<std::chrono::milliseconds>(tp).count()), dest);
+    }
+    dest.append(offset_, offset_ + sizeof(offset_));
+}
+
+SPDLOG_INLINE int64_t timestamp_renderer::epoch_micros(log_clock::time_point tp)
+{
+    return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(tp.time_since_epoch()).count());
+}
+
+SPDLOG_INLINE void timestamp_renderer::write2_(int n, char *dest)
+{
+    dest[0] = static_cast<char>('0' + n / 10 % 10);
+    dest[1] = static_cast<char>('0' + n % 10);
+}
+
+SPDLOG_INLINE void timestamp_renderer::update_cache_(log_clock::time_point tp)
+{
+    auto tt = log_clock::to_time_t(tp);
+    std::tm tm_time = time_type_ == pattern_time_type::local ? os::localtime(tt) : os::gmtime(tt);
+
+    // YYYY-mm-dd HH:MM:SS.
+    auto year = tm_time.tm_year + 1900;
+    write2_(year / 100, prefix_);
+    write2_(year % 100, prefix_ + 2);
+    prefix_[4] = '-';
+    write2_(tm_time.tm_mon + 1, prefix_ + 5);
+    prefix_[7] = '-';
+    write2_(tm_time.tm_mday, prefix_ + 8);
+    prefix_[10] = format_ == timestamp_format::rfc3339_nanos ? 'T' : ' ';
+    write2_(tm_time.tm_hour, prefix_ + 11);
+    prefix_[13] = ':';
+    write2_(tm_time.tm_min, prefix_ + 14);
+    prefix_[16] = ':';
+    write2_(tm_time.tm_sec, prefix_ + 17);
+    prefix_[19] = '.';
+
+    // +HH:MM
+    auto total_minutes = time_type_ == pattern_time_type::local ? os::utc_minutes_offset(tm_time) : 0;
+    offset_[0] = total_minutes < 0 ? '-' : '+';
+    if (total_minutes < 0)
+    {
+        total_minutes = -total_minutes;
+    }
+    write2_(total_minutes / 60, offset_ + 1);
+    offset_[3] = ':';
+    write2_(total_minutes % 60, offset_ + 4);
+}
+
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <spdlog/common.h>
+
+#include <chrono>
+
+namespace spdlog {
+
+// Format of the timestamp written by timestamp_renderer.
+enum class timestamp_format
+{
+    date_time,     // 2020-12-29 00:28:59.271-06:00
+    rfc3339_nanos, // 2020-12-29T00:28:59.271828182-06:00
+    epoch_micros   // 1609223339271828
+};
+
+namespace details {
+
+// Render log_msg::time without a full pattern_formatter.
+// The date, time of day and utc offset only change once per second, so they
+// are rendered once per second and cached. Only the fraction of the second is
+// formatted for each message.
+// Not thread safe; every formatter owns its own renderer.
+class SPDLOG_API timestamp_renderer
+{
+public:
+    explicit timestamp_renderer(timestamp_format format = timestamp_format::date_time, pattern_time_type time_type = pattern_time_type::local);
+
+    timestamp_format format() const;
+
+    pattern_time_type time_type() const;
+
+    // append the timestamp to dest.
+    // epoch_micros is rendered as digits only, the other formats are not quoted.
+    void render(log_clock::time_point tp, memory_buf_t &dest);
+
+    // microseconds since epoch, as rendered by the epoch_micros format.
+    static int64_t epoch_micros(log_clock::time_point tp);
+
+private:
+    timestamp_format format_;
+    pattern_time_type time_type_;
+
+    std::chrono::seconds cached_secs_{-1};
+    // "YYYY-mm-dd HH:MM:SS" followed by the fraction separator
+    char prefix_[20];
+    // "+HH:MM"
+    char offset_[6];
+
+    void update_cache_(log_clock::time_point tp);
+
+    static void write2_(int n, char *dest);
+};
+
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "timestamp_renderer-inl.h"
+#endif
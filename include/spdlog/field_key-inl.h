@@ -0,0 +1,71 @@
+#pragma once
+
+#include <spdlog/common.h>
+
+#ifdef SPDLOG_JSON_LOGGER
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/field_key.h>
+#endif
+
+#include <spdlog/json_writer.h>
+
+namespace spdlog {
+
+namespace details {
+
+SPDLOG_INLINE field_key_table &field_key_table::instance()
+{
+    // never destroyed: messages holding key ids can still be formatted while
+    // static objects are destroyed, e.g. by the async thread pool of the registry.
+    static auto *s_instance = new field_key_table();
+    return *s_instance;
+}
+
+SPDLOG_INLINE field_key_table::field_key_table()
+{
+    for (auto &chunk : chunks_)
+    {
+        chunk.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+SPDLOG_INLINE uint32_t field_key_table::intern(string_view_t name)
+{
+    std::string key(name.data(), name.size());
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = ids_.find(key);
+    if (it != ids_.end())
+    {
+        return it->second;
+    }
+
+    const size_t id = size_.load(std::memory_order_relaxed);
+    if (id >= chunk_size * max_chunks)
+    {
+        throw_spdlog_ex("field_key: too many interned keys");
+    }
+    auto *chunk = chunks_[id / chunk_size].load(std::memory_order_relaxed);
+    if (chunk == nullptr)
+    {
+        chunk = new interned_key[chunk_size];
+        chunks_[id / chunk_size].store(chunk, std::memory_order_release);
+    }
+    json_key rendered(key);
+    chunk[id % chunk_size].rendered.assign(rendered.rendered().data(), rendered.rendered().size());
+    chunk[id % chunk_size].name = key;
+    ids_.emplace(std::move(key), static_cast<uint32_t>(id));
+    size_.store(id + 1, std::memory_order_release);
+    return static_cast<uint32_t>(id);
+}
+
+} // namespace details
+
+SPDLOG_INLINE field_key::field_key(string_view_t name)
+    : id_(details::field_key_table::instance().intern(name))
+    , entry_(&details::field_key_table::instance().get(id_))
+{}
+
+} // namespace spdlog
+
+#endif
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <spdlog/common.h>
+
+#ifdef SPDLOG_JSON_LOGGER
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace spdlog {
+
+namespace details {
+
+// An interned key: its name, and its name rendered as a JSON object key ("key":).
+struct interned_key
+{
+    std::string name;
+    std::string rendered;
+};
+
+// Process wide table of interned field keys.
+// Interning takes a lock, looking a key up by id does not: entries are stored
+// in fixed size chunks which are never moved or freed, and the table itself is
+// never destroyed, so that ids stay valid until the process exits.
+class SPDLOG_API field_key_table
+{
+public:
+    static constexpr size_t chunk_size = 256;
+    static constexpr size_t max_chunks = 256;
+
+    static field_key_table &instance();
+
+    field_key_table(const field_key_table &) = delete;
+    field_key_table &operator=(const field_key_table &) = delete;
+
+    // return the id of the given key, adding it to the table if needed.
+    uint32_t intern(string_view_t name);
+
+    // the key with the given id. the id must have been returned by intern().
+    const interned_key &get(uint32_t id) const
+    {
+        return chunks_[id / chunk_size].load(std::memory_order_acquire)[id % chunk_size];
+    }
+
+    size_t size() const
+    {
+        return size_.load(std::memory_order_acquire);
+    }
+
+private:
+    field_key_table();
+
+    std::atomic<interned_key *> chunks_[max_chunks];
+    std::atomic<size_t> size_{0};
+    std::mutex mutex_;
+    std::unordered_map<std::string, uint32_t> ids_;
+};
+
+} // namespace details
+
+// A typed field key interned in the process wide table.
+// Typed fields added with a field_key carry its id instead of a copy of the
+// key, and json_formatter copies its pre-rendered "key": bytes as is.
+// Intern keys once, e.g. in a static, rather than on every message:
+//
+//   static const spdlog::field_key user_id("user_id");
+//   logger->info("request").field(user_id, 42);
+class SPDLOG_API field_key
+{
+public:
+    explicit field_key(string_view_t name);
+
+    uint32_t id() const
+    {
+        return id_;
+    }
+
+    string_view_t name() const
+    {
+        return string_view_t(entry_->name.data(), entry_->name.size());
+    }
+
+    // the quoted and escaped key, followed by a colon.
+    string_view_t rendered() const
+    {
+        return string_view_t(entry_->rendered.data(), entry_->rendered.size());
+    }
+
+private:
+    uint32_t id_;
+    const details::interned_key *entry_;
+};
+
+namespace details {
+
+// Key of a typed field: either a plain string or an interned field_key.
+struct field_name
+{
+    field_name(string_view_t key)
+        : name(key)
+    {}
+    field_name(const char *key)
+        : name(key)
+    {}
+    field_name(const std::string &key)
+        : name(key.data(), key.size())
+    {}
+    field_name(const field_key &key)
+        : name(key.name())
+        , id(key.id())
+        , interned(true)
+    {}
+
+    string_view_t name;
+    uint32_t id{0};
+    bool interned{false};
+};
+
+} // namespace details
+
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+// field_key-inl.h renders keys with json_writer, which needs log_fields.h to be complete.
+// log_fields.h includes it once it is.
+#    include <spdlog/details/log_fields.h>
+#endif
+
+#endif
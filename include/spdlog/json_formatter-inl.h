@@ -19,17 +19,106 @@ SPDLOG_INLINE populators::populator_set json_formatter::make_default_populators_
         details::make_unique<populators::message_populator>());
 }
 
-SPDLOG_INLINE json_formatter::json_formatter(std::string eol)
-    : kEOL(std::move(eol))
+SPDLOG_INLINE json_formatter::json_formatter(std::string eol, json_serializer serializer, json_encoding encoding)
+    : kEOL(encoding == json_encoding::text ? std::move(eol) : std::string())
     , populators_(make_default_populators_())
-{}
+    , serializer_(serializer)
+    , writer_(encoding)
+{
+    compile_plan_();
+}
 
-SPDLOG_INLINE json_formatter::json_formatter(populators::populator_set &&populators, std::string eol)
-    : kEOL(std::move(eol))
+SPDLOG_INLINE json_formatter::json_formatter(
+    populators::populator_set &&populators, std::string eol, json_serializer serializer, json_encoding encoding)
+    : kEOL(encoding == json_encoding::text ? std::move(eol) : std::string())
     , populators_(std::move(populators))
-{}
+    , serializer_(serializer)
+    , writer_(encoding)
+{
+    compile_plan_();
+}
+
+SPDLOG_INLINE void json_formatter::compile_plan_()
+{
+    plan_.clear();
+    plan_.reserve(populators_.size());
+    for (const auto &populator : populators_)
+    {
+        auto plan = populator->plan();
+        if (plan.key != nullptr)
+        {
+            plan_.push_back(planned_field{plan.kind, *plan.key, populator.get()});
+        }
+        else
+        {
+            plan_.push_back(planned_field{populators::field_kind::custom, string_view_t(), populator.get()});
+        }
+    }
+}
 
 SPDLOG_INLINE void json_formatter::format(const details::log_msg &msg, memory_buf_t &dest)
+{
+    if (serializer_ == json_serializer::dom)
+    {
+        format_dom_(msg, dest);
+    }
+    else
+    {
+        format_stream_(msg, dest);
+    }
+}
+
+SPDLOG_INLINE void json_formatter::format_stream_(const details::log_msg &msg, memory_buf_t &dest)
+{
+    writer_.begin_object(dest, msg.params, msg.fields);
+    for (const auto &field : plan_)
+    {
+        // the built-in fields are written here, as their populators would write them
+        switch (field.kind)
+        {
+        case populators::field_kind::level:
+            writer_.field(field.key, level::to_string_view(msg.level));
+            break;
+        case populators::field_kind::logger_name:
+            if (msg.logger_name.size() > 0)
+            {
+                writer_.field(field.key, msg.logger_name);
+            }
+            break;
+        case populators::field_kind::message:
+            writer_.field(field.key, msg.payload);
+            break;
+        case populators::field_kind::pid:
+            writer_.field(field.key, details::os::pid());
+            break;
+        case populators::field_kind::thread_id:
+            writer_.field(field.key, msg.thread_id);
+            break;
+        case populators::field_kind::timestamp:
+            writer_.field(field.key, std::chrono::duration_cast<std::chrono::seconds>(msg.time.time_since_epoch()).count());
+            break;
+        // these keep a buffer or a cache: call their write(), without a virtual call
+        case populators::field_kind::date_time:
+            static_cast<populators::date_time_populator *>(field.populator)->date_time_populator::write(msg, writer_);
+            break;
+        case populators::field_kind::pattern:
+            static_cast<populators::pattern_populator *>(field.populator)->pattern_populator::write(msg, writer_);
+            break;
+        case populators::field_kind::custom:
+            field.populator->write(msg, writer_);
+            break;
+        }
+    }
+    if (msg.params)
+    {
+        writer_.fields(*msg.params);
+    }
+    writer_.typed_fields(msg.fields);
+    writer_.end_object();
+    dest.append(kEOL.data(), kEOL.data() + kEOL.size());
+}
+
+SPDLOG_INLINE void json_formatter::format_dom_(const details::log_msg &msg, memory_buf_t &dest)
 {
     nlohmann::json entry = nlohmann::json::object();
     for (const auto &populator : populators_)
@@ -43,7 +132,25 @@ SPDLOG_INLINE void json_formatter::format(const details::log_msg &msg, memory_bu
             entry[kv.key()] = kv.value();
         }
     }
-    dest.append(entry.dump() + kEOL);
+    details::log_fields::for_each(msg.fields, [&entry](const details::field &f) {
+        entry[std::string(f.key.data(), f.key.size())] = details::log_fields::to_json(f);
+    });
+    switch (writer_.encoding())
+    {
+    case json_encoding::text:
+        dest.append(entry.dump() + kEOL);
+        break;
+    case json_encoding::msgpack: {
+        auto bytes = nlohmann::json::to_msgpack(entry);
+        dest.append(reinterpret_cast<const char *>(bytes.data()), reinterpret_cast<const char *>(bytes.data() + bytes.size()));
+        break;
+    }
+    case json_encoding::cbor: {
+        auto bytes = nlohmann::json::to_cbor(entry);
+        dest.append(reinterpret_cast<const char *>(bytes.data()), reinterpret_cast<const char *>(bytes.data() + bytes.size()));
+        break;
+    }
+    }
 }
 
 SPDLOG_INLINE std::unique_ptr<formatter> json_formatter::clone() const
@@ -53,7 +160,7 @@ SPDLOG_INLINE std::unique_ptr<formatter> json_formatter::clone() const
     {
         populators.insert(populator->clone());
     }
-    return details::make_unique<json_formatter>(std::move(populators), kEOL);
+    return details::make_unique<json_formatter>(std::move(populators), kEOL, serializer_, writer_.encoding());
 }
 
 } // namespace spdlog
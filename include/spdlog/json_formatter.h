@@ -6,13 +6,26 @@
 
 #include <spdlog/details/os.h>
 #include <spdlog/formatter.h>
+#include <spdlog/json_writer.h>
 #include <spdlog/populators.h>
 
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace spdlog {
 
+// How json_formatter turns a message into JSON text.
+// stream - populators and params are written straight into the output buffer (default).
+//          populators setting the same key both write it.
+// dom - populators fill an nlohmann::json object which is then dumped. slower, but
+//       lets populators inspect and remove fields set by other populators. the last one setting a key wins.
+enum class json_serializer
+{
+    stream,
+    dom
+};
+
 class json_formatter : public formatter
 {
 private:
@@ -20,12 +33,35 @@ private:
 
     populators::populator_set populators_;
 
+    // the populators compiled into a flat array, in order: the kind of each field and its
+    // pre-rendered key. the stream serializer walks it instead of calling each populator.
+    struct planned_field
+    {
+        populators::field_kind kind;
+        json_writer::key_view key;
+        populators::populator *populator;
+    };
+    std::vector<planned_field> plan_;
+
+    json_serializer serializer_;
+
+    json_writer writer_;
+
     static populators::populator_set make_default_populators_();
 
+    void compile_plan_();
+
+    void format_stream_(const details::log_msg &msg, memory_buf_t &dest);
+
+    void format_dom_(const details::log_msg &msg, memory_buf_t &dest);
+
 public:
-    json_formatter(std::string eol = spdlog::details::os::default_eol);
+    // with a binary encoding (msgpack or cbor), each message is written as a single map and eol is not appended.
+    json_formatter(std::string eol = spdlog::details::os::default_eol, json_serializer serializer = json_serializer::stream,
+        json_encoding encoding = json_encoding::text);
 
-    json_formatter(populators::populator_set &&populators, std::string eol = spdlog::details::os::default_eol);
+    json_formatter(populators::populator_set &&populators, std::string eol = spdlog::details::os::default_eol,
+        json_serializer serializer = json_serializer::stream, json_encoding encoding = json_encoding::text);
 
     virtual void format(const details::log_msg &msg, memory_buf_t &dest) override;
 
@@ -0,0 +1,649 @@
+#pragma once
+
+#include <spdlog/common.h>
+
+#ifdef SPDLOG_JSON_LOGGER
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/json_writer.h>
+#endif
+
+#include <spdlog/details/fmt_helper.h>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define SPDLOG_JSON_SSE2
+#    include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#    define SPDLOG_JSON_AVX2
+#    include <immintrin.h>
+#endif
+#if defined(SPDLOG_JSON_SSE2) && defined(_MSC_VER)
+#    include <intrin.h>
+#endif
+
+namespace spdlog {
+
+namespace details {
+
+// return the length of the valid UTF-8 sequence starting at p, or 0 if it is invalid.
+// on return, consumed holds the number of bytes covered by the (possibly invalid) sequence.
+SPDLOG_INLINE size_t utf8_sequence_length(const unsigned char *p, const unsigned char *end, size_t &consumed)
+{
+    const unsigned char b = *p;
+    unsigned char lo = 0x80;
+    unsigned char hi = 0xBF;
+    size_t n;
+    if (b >= 0xC2 && b <= 0xDF)
+    {
+        n = 2;
+    }
+    else if (b >= 0xE0 && b <= 0xEF)
+    {
+        n = 3;
+        if (b == 0xE0)
+        {
+            lo = 0xA0;
+        }
+        else if (b == 0xED)
+        {
+            hi = 0x9F;
+        }
+    }
+    else if (b >= 0xF0 && b <= 0xF4)
+    {
+        n = 4;
+        if (b == 0xF0)
+        {
+            lo = 0x90;
+        }
+        else if (b == 0xF4)
+        {
+            hi = 0x8F;
+        }
+    }
+    else
+    {
+        consumed = 1;
+        return 0;
+    }
+
+    size_t i = 1;
+    for (; i < n && p + i < end; ++i)
+    {
+        if (p[i] < lo || p[i] > hi)
+        {
+            break;
+        }
+        lo = 0x80;
+        hi = 0xBF;
+    }
+    consumed = i;
+    return i == n ? n : 0;
+}
+
+#ifdef SPDLOG_JSON_SSE2
+inline unsigned count_trailing_zeros(uint32_t mask)
+{
+#    ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#    else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#    endif
+}
+#endif
+
+// return the first byte in [p, end) which cannot be copied to a JSON string as is:
+// a control character, a quote, a backslash or a non-ASCII byte.
+// scans 32 (AVX2) or 16 (SSE2) bytes at a time when available. in a signed byte
+// compare, non-ASCII bytes are negative, so "less than a space" catches both them
+// and the control characters.
+SPDLOG_INLINE const unsigned char *find_json_escape(const unsigned char *p, const unsigned char *end)
+{
+#ifdef SPDLOG_JSON_AVX2
+    {
+        const __m256i quote = _mm256_set1_epi8('"');
+        const __m256i backslash = _mm256_set1_epi8('\\');
+        const __m256i space = _mm256_set1_epi8(0x20);
+        while (end - p >= 32)
+        {
+            const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+            const __m256i special = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)), _mm256_cmpgt_epi8(space, chunk));
+            const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(special));
+            if (mask != 0)
+            {
+                return p + count_trailing_zeros(mask);
+            }
+            p += 32;
+        }
+    }
+#endif
+#ifdef SPDLOG_JSON_SSE2
+    {
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i space = _mm_set1_epi8(0x20);
+        while (end - p >= 16)
+        {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            const __m128i special =
+                _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)), _mm_cmplt_epi8(chunk, space));
+            const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(special));
+            if (mask != 0)
+            {
+                return p + count_trailing_zeros(mask);
+            }
+            p += 16;
+        }
+    }
+#endif
+    while (p < end && *p >= 0x20 && *p < 0x80 && *p != '"' && *p != '\\')
+    {
+        ++p;
+    }
+    return p;
+}
+
+// store the bytes of an integer at out, most significant first.
+template<typename T>
+inline void store_big_endian(T value, char *out)
+{
+    using unsigned_t = typename std::make_unsigned<T>::type;
+    const auto bits = static_cast<unsigned_t>(value);
+    for (size_t i = 0; i < sizeof(T); ++i)
+    {
+        out[i] = static_cast<char>((bits >> (8 * (sizeof(T) - 1 - i))) & 0xff);
+    }
+}
+
+template<typename T>
+inline void append_big_endian(T value, memory_buf_t &dest)
+{
+    char bytes[sizeof(T)];
+    store_big_endian(value, bytes);
+    dest.append(bytes, bytes + sizeof(T));
+}
+
+} // namespace details
+
+SPDLOG_INLINE json_key::json_key(const std::string &name)
+    : name_(name)
+{
+    memory_buf_t buf;
+    json_writer::write_string(name_, buf);
+    buf.push_back(':');
+    rendered_.assign(buf.data(), buf.size());
+}
+
+SPDLOG_INLINE json_writer::json_writer(json_encoding encoding)
+    : encoding_(encoding)
+    , adapter_(std::make_shared<details::memory_buf_output_adapter>())
+    , serializer_(details::make_unique<serializer_t>(adapter_, ' ', nlohmann::detail::error_handler_t::replace))
+    , binary_(details::make_unique<binary_writer_t>(adapter_))
+{}
+
+SPDLOG_INLINE void json_writer::begin_object(memory_buf_t &dest, const nlohmann::json *shadow, string_view_t shadow_fields)
+{
+    dest_ = &dest;
+    adapter_->dest = &dest;
+    shadow_ = (shadow && !shadow->empty()) ? shadow : nullptr;
+    shadow_fields_ = shadow_fields;
+    first_ = true;
+    if (encoding_ == json_encoding::text)
+    {
+        dest_->push_back('{');
+        return;
+    }
+    // map with a 32 bit field count, filled in by end_object()
+    object_start_ = dest_->size();
+    count_ = 0;
+    dest_->push_back(static_cast<char>(encoding_ == json_encoding::msgpack ? 0xdf : 0xba));
+    details::append_big_endian(uint32_t{0}, *dest_);
+}
+
+SPDLOG_INLINE void json_writer::end_object()
+{
+    if (encoding_ == json_encoding::text)
+    {
+        dest_->push_back('}');
+        return;
+    }
+    details::store_big_endian(count_, dest_->data() + object_start_ + 1);
+}
+
+SPDLOG_INLINE void json_writer::field(key_view key, string_view_t value)
+{
+    if (!key_(key))
+    {
+        return;
+    }
+    if (encoding_ == json_encoding::text)
+    {
+        write_string(value, *dest_);
+    }
+    else
+    {
+        binary_string_(value);
+    }
+}
+
+SPDLOG_INLINE void json_writer::field(key_view key, const char *value)
+{
+    field(key, string_view_t(value));
+}
+
+SPDLOG_INLINE void json_writer::field(key_view key, const std::string &value)
+{
+    field(key, string_view_t(value.data(), value.size()));
+}
+
+SPDLOG_INLINE void json_writer::field(key_view key, bool value)
+{
+    if (!key_(key))
+    {
+        return;
+    }
+    switch (encoding_)
+    {
+    case json_encoding::text:
+        details::fmt_helper::append_string_view(value ? "true" : "false", *dest_);
+        break;
+    case json_encoding::msgpack:
+        dest_->push_back(static_cast<char>(value ? 0xc3 : 0xc2));
+        break;
+    case json_encoding::cbor:
+        dest_->push_back(static_cast<char>(value ? 0xf5 : 0xf4));
+        break;
+    }
+}
+
+SPDLOG_INLINE void json_writer::field(key_view key, std::nullptr_t)
+{
+    if (!key_(key))
+    {
+        return;
+    }
+    switch (encoding_)
+    {
+    case json_encoding::text:
+        details::fmt_helper::append_string_view("null", *dest_);
+        break;
+    case json_encoding::msgpack:
+        dest_->push_back(static_cast<char>(0xc0));
+        break;
+    case json_encoding::cbor:
+        dest_->push_back(static_cast<char>(0xf6));
+        break;
+    }
+}
+
+SPDLOG_INLINE void json_writer::field(key_view key, double value)
+{
+    if (!key_(key))
+    {
+        return;
+    }
+    if (encoding_ == json_encoding::text)
+    {
+        write_double(value, *dest_);
+    }
+    else
+    {
+        binary_double_(value);
+    }
+}
+
+SPDLOG_INLINE void json_writer::field(key_view key, const nlohmann::json &value)
+{
+    if (!key_(key))
+    {
+        return;
+    }
+    switch (encoding_)
+    {
+    case json_encoding::text:
+        serializer_->dump(value, false, false, 0);
+        break;
+    case json_encoding::msgpack:
+        binary_->write_msgpack(value);
+        break;
+    case json_encoding::cbor:
+        binary_->write_cbor(value);
+        break;
+    }
+}
+
+SPDLOG_INLINE void json_writer::fields(const nlohmann::json &object)
+{
+    const auto *shadow = shadow_;
+    shadow_ = nullptr;
+    for (const auto &kv : object.items())
+    {
+        field(kv.key(), kv.value());
+    }
+    shadow_ = shadow;
+}
+
+SPDLOG_INLINE void json_writer::typed_fields(string_view_t encoded)
+{
+    const auto *shadow = shadow_;
+    auto shadow_fields = shadow_fields_;
+    shadow_ = nullptr;
+    shadow_fields_ = string_view_t{};
+    const char *p = encoded.data();
+    const char *end = p + encoded.size();
+    while (p < end)
+    {
+        auto f = details::log_fields::read(p);
+        // the last field with a given key wins, as when building a DOM
+        if (details::log_fields::contains(string_view_t(p, static_cast<size_t>(end - p)), f.key))
+        {
+            continue;
+        }
+        key_view key(f.key);
+        key.rendered = f.rendered_key;
+        switch (f.type)
+        {
+        case details::field_type::null:
+            field(key, nullptr);
+            break;
+        case details::field_type::boolean:
+            field(key, f.boolean);
+            break;
+        case details::field_type::int64:
+            field(key, f.int64);
+            break;
+        case details::field_type::uint64:
+            field(key, f.uint64);
+            break;
+        case details::field_type::float64:
+            field(key, f.float64);
+            break;
+        case details::field_type::string:
+            field(key, f.string);
+            break;
+        }
+    }
+    shadow_ = shadow;
+    shadow_fields_ = shadow_fields;
+}
+
+SPDLOG_INLINE bool json_writer::shadow_contains_(string_view_t name)
+{
+    // nlohmann::json only looks keys up by std::string: reuse one, so that the lookup does not allocate
+    shadow_key_.assign(name.data(), name.size());
+    return shadow_->find(shadow_key_) != shadow_->end();
+}
+
+SPDLOG_INLINE bool json_writer::key_(const key_view &key)
+{
+    if (shadow_ && shadow_contains_(key.name))
+    {
+        return false;
+    }
+    if (shadow_fields_.size() > 0 && details::log_fields::contains(shadow_fields_, key.name))
+    {
+        return false;
+    }
+    if (encoding_ != json_encoding::text)
+    {
+        ++count_;
+        binary_string_(key.name);
+        return true;
+    }
+    if (!first_)
+    {
+        dest_->push_back(',');
+    }
+    first_ = false;
+    if (key.rendered.size() > 0)
+    {
+        details::fmt_helper::append_string_view(key.rendered, *dest_);
+    }
+    else
+    {
+        write_string(key.name, *dest_);
+        dest_->push_back(':');
+    }
+    return true;
+}
+
+SPDLOG_INLINE void json_writer::write_string(string_view_t value, memory_buf_t &dest)
+{
+    static const char hex[] = "0123456789abcdef";
+    const auto *p = reinterpret_cast<const unsigned char *>(value.data());
+    const auto *end = p + value.size();
+
+    dest.push_back('"');
+    while (p < end)
+    {
+        // copy the longest run of characters which need no escaping
+        const auto *run = p;
+        p = details::find_json_escape(p, end);
+        dest.append(reinterpret_cast<const char *>(run), reinterpret_cast<const char *>(p));
+        if (p == end)
+        {
+            break;
+        }
+
+        const unsigned char c = *p;
+        if (c >= 0x80)
+        {
+            size_t consumed;
+            auto len = details::utf8_sequence_length(p, end, consumed);
+            if (len > 0)
+            {
+                dest.append(reinterpret_cast<const char *>(p), reinterpret_cast<const char *>(p + len));
+            }
+            else
+            {
+                details::fmt_helper::append_string_view("\xEF\xBF\xBD", dest);
+            }
+            p += consumed;
+            continue;
+        }
+
+        dest.push_back('\\');
+        switch (c)
+        {
+        case '"':
+            dest.push_back('"');
+            break;
+        case '\\':
+            dest.push_back('\\');
+            break;
+        case '\b':
+            dest.push_back('b');
+            break;
+        case '\f':
+            dest.push_back('f');
+            break;
+        case '\n':
+            dest.push_back('n');
+            break;
+        case '\r':
+            dest.push_back('r');
+            break;
+        case '\t':
+            dest.push_back('t');
+            break;
+        default: {
+            const char esc[] = {'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+            dest.append(esc, esc + sizeof(esc));
+        }
+        }
+        ++p;
+    }
+    dest.push_back('"');
+}
+
+SPDLOG_INLINE void json_writer::write_double(double value, memory_buf_t &dest)
+{
+    if (!std::isfinite(value))
+    {
+        details::fmt_helper::append_string_view("null", dest);
+        return;
+    }
+    char buf[64];
+    auto *last = nlohmann::detail::to_chars(buf, buf + sizeof(buf), value);
+    dest.append(buf, last);
+}
+
+SPDLOG_INLINE void json_writer::cbor_head_(uint8_t major, uint64_t value)
+{
+    const auto m = static_cast<uint8_t>(major << 5);
+    if (value < 24)
+    {
+        dest_->push_back(static_cast<char>(m | value));
+    }
+    else if (value <= 0xff)
+    {
+        dest_->push_back(static_cast<char>(m | 24));
+        details::append_big_endian(static_cast<uint8_t>(value), *dest_);
+    }
+    else if (value <= 0xffff)
+    {
+        dest_->push_back(static_cast<char>(m | 25));
+        details::append_big_endian(static_cast<uint16_t>(value), *dest_);
+    }
+    else if (value <= 0xffffffff)
+    {
+        dest_->push_back(static_cast<char>(m | 26));
+        details::append_big_endian(static_cast<uint32_t>(value), *dest_);
+    }
+    else
+    {
+        dest_->push_back(static_cast<char>(m | 27));
+        details::append_big_endian(value, *dest_);
+    }
+}
+
+SPDLOG_INLINE void json_writer::binary_string_(string_view_t value)
+{
+    const auto size = value.size();
+    if (encoding_ == json_encoding::cbor)
+    {
+        cbor_head_(3, size);
+    }
+    else if (size <= 31)
+    {
+        dest_->push_back(static_cast<char>(0xa0 | size));
+    }
+    else if (size <= 0xff)
+    {
+        dest_->push_back(static_cast<char>(0xd9));
+        details::append_big_endian(static_cast<uint8_t>(size), *dest_);
+    }
+    else if (size <= 0xffff)
+    {
+        dest_->push_back(static_cast<char>(0xda));
+        details::append_big_endian(static_cast<uint16_t>(size), *dest_);
+    }
+    else
+    {
+        dest_->push_back(static_cast<char>(0xdb));
+        details::append_big_endian(static_cast<uint32_t>(size), *dest_);
+    }
+    details::fmt_helper::append_string_view(value, *dest_);
+}
+
+SPDLOG_INLINE void json_writer::binary_int_(int64_t value)
+{
+    if (value >= 0)
+    {
+        binary_uint_(static_cast<uint64_t>(value));
+    }
+    else if (encoding_ == json_encoding::cbor)
+    {
+        cbor_head_(1, static_cast<uint64_t>(-(value + 1)));
+    }
+    else if (value >= -32)
+    {
+        details::append_big_endian(static_cast<int8_t>(value), *dest_);
+    }
+    else if (value >= INT8_MIN)
+    {
+        dest_->push_back(static_cast<char>(0xd0));
+        details::append_big_endian(static_cast<int8_t>(value), *dest_);
+    }
+    else if (value >= INT16_MIN)
+    {
+        dest_->push_back(static_cast<char>(0xd1));
+        details::append_big_endian(static_cast<int16_t>(value), *dest_);
+    }
+    else if (value >= INT32_MIN)
+    {
+        dest_->push_back(static_cast<char>(0xd2));
+        details::append_big_endian(static_cast<int32_t>(value), *dest_);
+    }
+    else
+    {
+        dest_->push_back(static_cast<char>(0xd3));
+        details::append_big_endian(value, *dest_);
+    }
+}
+
+SPDLOG_INLINE void json_writer::binary_uint_(uint64_t value)
+{
+    if (encoding_ == json_encoding::cbor)
+    {
+        cbor_head_(0, value);
+    }
+    else if (value <= 0x7f)
+    {
+        dest_->push_back(static_cast<char>(value));
+    }
+    else if (value <= 0xff)
+    {
+        dest_->push_back(static_cast<char>(0xcc));
+        details::append_big_endian(static_cast<uint8_t>(value), *dest_);
+    }
+    else if (value <= 0xffff)
+    {
+        dest_->push_back(static_cast<char>(0xcd));
+        details::append_big_endian(static_cast<uint16_t>(value), *dest_);
+    }
+    else if (value <= 0xffffffff)
+    {
+        dest_->push_back(static_cast<char>(0xce));
+        details::append_big_endian(static_cast<uint32_t>(value), *dest_);
+    }
+    else
+    {
+        dest_->push_back(static_cast<char>(0xcf));
+        details::append_big_endian(value, *dest_);
+    }
+}
+
+SPDLOG_INLINE void json_writer::binary_double_(double value)
+{
+    // like nlohmann, use a 32 bit float when it holds the value exactly
+    const bool msgpack = encoding_ == json_encoding::msgpack;
+    if (value >= static_cast<double>(std::numeric_limits<float>::lowest()) && value <= static_cast<double>(std::numeric_limits<float>::max()) &&
+        static_cast<double>(static_cast<float>(value)) == value)
+    {
+        const auto f = static_cast<float>(value);
+        uint32_t bits;
+        std::memcpy(&bits, &f, sizeof(bits));
+        dest_->push_back(static_cast<char>(msgpack ? 0xca : 0xfa));
+        details::append_big_endian(bits, *dest_);
+    }
+    else
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        dest_->push_back(static_cast<char>(msgpack ? 0xcb : 0xfb));
+        details::append_big_endian(bits, *dest_);
+    }
+}
+
+} // namespace spdlog
+
+#endif
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <spdlog/common.h>
+
+#ifdef SPDLOG_JSON_LOGGER
+
+#include <spdlog/details/fmt_helper.h>
+#include <spdlog/details/log_fields.h>
+#include <spdlog/json.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+namespace spdlog {
+
+namespace details {
+
+// nlohmann output adapter appending to a memory_buf_t.
+struct memory_buf_output_adapter : public nlohmann::detail::output_adapter_protocol<char>
+{
+    memory_buf_t *dest = nullptr;
+
+    void write_character(char c) override
+    {
+        dest->push_back(c);
+    }
+
+    void write_characters(const char *s, std::size_t length) override
+    {
+        dest->append(s, s + length);
+    }
+};
+
+} // namespace details
+
+// Output encoding of json_writer.
+// text - JSON text.
+// msgpack, cbor - a MessagePack or CBOR map. Each object is a complete item whose
+//                 header carries the field count, so records need no separator.
+//                 Strings are written as is, without UTF-8 validation.
+enum class json_encoding
+{
+    text,
+    msgpack,
+    cbor
+};
+
+// Object key rendered once as "key": so that it can be copied to the output as is.
+class SPDLOG_API json_key
+{
+public:
+    explicit json_key(const std::string &name);
+
+    const std::string &name() const
+    {
+        return name_;
+    }
+
+    // the quoted and escaped key, followed by a colon.
+    string_view_t rendered() const
+    {
+        return string_view_t(rendered_.data(), rendered_.size());
+    }
+
+private:
+    std::string name_;
+    std::string rendered_;
+};
+
+// Streaming JSON writer used by json_formatter.
+// Writes a single flat object straight into a memory_buf_t without building
+// an nlohmann::json DOM. Keys and string values are escaped on the fly;
+// invalid UTF-8 sequences are replaced by U+FFFD.
+//
+// Fields whose key is present in the shadow object (the extra params of the
+// message being formatted) or in the shadow typed fields are skipped, so that
+// params and typed fields override populator fields in the same way they do
+// when building a DOM. Typed fields also override params.
+//
+// With a binary encoding, the same object is written as a MessagePack or CBOR map.
+class SPDLOG_API json_writer
+{
+public:
+    explicit json_writer(json_encoding encoding = json_encoding::text);
+
+    json_writer(const json_writer &) = delete;
+    json_writer &operator=(const json_writer &) = delete;
+
+    // key of a field. plain keys are escaped on every write, json_keys and field_keys are copied as is.
+    struct key_view
+    {
+        key_view(string_view_t key)
+            : name(key)
+        {}
+        key_view(const char *key)
+            : name(key)
+        {}
+        key_view(const std::string &key)
+            : name(key.data(), key.size())
+        {}
+        key_view(const json_key &key)
+            : name(key.name().data(), key.name().size())
+            , rendered(key.rendered())
+        {}
+        key_view(const field_key &key)
+            : name(key.name())
+            , rendered(key.rendered())
+        {}
+
+        string_view_t name;
+        string_view_t rendered;
+    };
+
+    // bind the writer to the given output buffer and start a new object.
+    void begin_object(memory_buf_t &dest, const nlohmann::json *shadow = nullptr, string_view_t shadow_fields = {});
+    void end_object();
+
+    void field(key_view key, string_view_t value);
+    void field(key_view key, const char *value);
+    void field(key_view key, const std::string &value);
+    void field(key_view key, bool value);
+    void field(key_view key, std::nullptr_t);
+    void field(key_view key, double value);
+    void field(key_view key, const nlohmann::json &value);
+
+    template<typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, int>::type = 0>
+    void field(key_view key, T value)
+    {
+        if (!key_(key))
+        {
+            return;
+        }
+        if (encoding_ == json_encoding::text)
+        {
+            details::fmt_helper::append_int(value, *dest_);
+        }
+        else if (std::is_signed<T>::value)
+        {
+            binary_int_(static_cast<int64_t>(value));
+        }
+        else
+        {
+            binary_uint_(static_cast<uint64_t>(value));
+        }
+    }
+
+    // write every member of the given object. the shadow object is not consulted.
+    void fields(const nlohmann::json &object);
+
+    // write every field encoded by details::log_fields, the last one of each key only. no shadow is consulted.
+    void typed_fields(string_view_t encoded);
+
+    json_encoding encoding() const
+    {
+        return encoding_;
+    }
+
+    // write the given string to dest as a quoted and escaped JSON string.
+    static void write_string(string_view_t value, memory_buf_t &dest);
+
+    // write the given double to dest the same way nlohmann::json::dump() does.
+    static void write_double(double value, memory_buf_t &dest);
+
+private:
+    using serializer_t = nlohmann::detail::serializer<nlohmann::json>;
+    using binary_writer_t = nlohmann::detail::binary_writer<nlohmann::json, char>;
+
+    json_encoding encoding_;
+    memory_buf_t *dest_{nullptr};
+    const nlohmann::json *shadow_{nullptr};
+    string_view_t shadow_fields_;
+    std::string shadow_key_;
+    bool first_{true};
+    size_t object_start_{0};
+    uint32_t count_{0};
+    std::shared_ptr<details::memory_buf_output_adapter> adapter_;
+    std::unique_ptr<serializer_t> serializer_;
+    std::unique_ptr<binary_writer_t> binary_;
+
+    // write the (comma separated) key. return false if the field should be skipped.
+    bool key_(const key_view &key);
+    bool shadow_contains_(string_view_t name);
+
+    // MessagePack / CBOR values
+    void cbor_head_(uint8_t major, uint64_t value);
+    void binary_string_(string_view_t value);
+    void binary_int_(int64_t value);
+    void binary_uint_(uint64_t value);
+    void binary_double_(double value);
+};
+
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "json_writer-inl.h"
+#endif
+
+#endif
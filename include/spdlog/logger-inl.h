@@ -174,6 +174,18 @@ SPDLOG_INLINE void logger::executor_callback(const spdlog::details::log_msg &log
     }
 }
 
+SPDLOG_INLINE void logger::executor_callback(details::log_msg_buffer &&log_msg, bool log_enabled, bool traceback_enabled)
+{
+    if (traceback_enabled)
+    {
+        tracer_.push_back(log_msg);
+    }
+    if (log_enabled)
+    {
+        sink_owned_(std::move(log_msg));
+    }
+}
+
 // protected methods
 SPDLOG_INLINE SPDLOG_EXECUTOR_T logger::log_it_(const spdlog::details::log_msg &log_msg, bool log_enabled, bool traceback_enabled)
 {
@@ -185,6 +197,11 @@ SPDLOG_INLINE SPDLOG_EXECUTOR_T logger::log_it_(const spdlog::details::log_msg &
 #endif
 }
 
+SPDLOG_INLINE void logger::sink_owned_(details::log_msg_buffer &&msg)
+{
+    sink_it_(msg);
+}
+
 SPDLOG_INLINE void logger::sink_it_(const details::log_msg &msg)
 {
     for (auto &sink : sinks_)
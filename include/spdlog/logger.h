@@ -332,6 +332,8 @@ public:
     virtual std::shared_ptr<logger> clone(std::string logger_name);
 
     void executor_callback(const details::log_msg &log_msg, bool log_enabled, bool traceback_enabled);
+    // same, but the message may be moved from (see sink_owned_()).
+    void executor_callback(details::log_msg_buffer &&log_msg, bool log_enabled, bool traceback_enabled);
 
 protected:
     std::string name_;
@@ -353,10 +355,17 @@ protected:
         }
         SPDLOG_TRY
         {
+#ifdef SPDLOG_JSON_LOGGER
+            // format straight into the buffer of the entry, saving a copy of the payload
+            details::log_msg log_msg(loc, name_, lvl, string_view_t{});
+            return details::executor(this, log_msg, log_enabled, traceback_enabled,
+                [&](memory_buf_t &buf) { fmt::detail::vformat_to(buf, fmt, fmt::make_format_args(args...)); });
+#else
             memory_buf_t buf;
             fmt::detail::vformat_to(buf, fmt, fmt::make_format_args(args...));
             details::log_msg log_msg(loc, name_, lvl, string_view_t(buf.data(), buf.size()));
             return log_it_(log_msg, log_enabled, traceback_enabled);
+#endif
         }
         SPDLOG_LOGGER_CATCH(loc)
         return SPDLOG_EXECUTOR_T{};
@@ -413,6 +422,9 @@ protected:
     // and save backtrace (if backtrace is enabled).
     SPDLOG_EXECUTOR_T log_it_(const details::log_msg &log_msg, bool log_enabled, bool traceback_enabled);
     virtual void sink_it_(const details::log_msg &msg);
+    // sink a message the caller no longer needs. the default implementation calls sink_it_().
+    // async_logger moves it into the queue instead of copying it (params included).
+    virtual void sink_owned_(details::log_msg_buffer &&msg);
     virtual void flush_();
     void dump_backtrace_();
     bool should_flush_(const details::log_msg &msg);
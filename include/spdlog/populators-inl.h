@@ -12,6 +12,16 @@ namespace spdlog {
 
 namespace populators {
 
+SPDLOG_INLINE void populator::write(const details::log_msg &msg, json_writer &dest)
+{
+    nlohmann::json tmp = nlohmann::json::object();
+    populate(msg, tmp);
+    for (const auto &kv : tmp.items())
+    {
+        dest.field(kv.key(), kv.value());
+    }
+}
+
 SPDLOG_INLINE pattern_populator::pattern_populator(const std::string &key, const std::string &pattern)
     : kKey(key)
     , pf_(details::make_unique<spdlog::pattern_formatter>(pattern, pattern_time_type::local, ""))
@@ -26,7 +36,19 @@ SPDLOG_INLINE void pattern_populator::populate(const details::log_msg &msg, nloh
 {
     memory_buf_t tmp;
     pf_->format(msg, tmp);
-    dest[kKey] = std::string(tmp.data(), tmp.size());
+    dest[kKey.name()] = std::string(tmp.data(), tmp.size());
+}
+
+SPDLOG_INLINE void pattern_populator::write(const details::log_msg &msg, json_writer &dest)
+{
+    buf_.clear();
+    pf_->format(msg, buf_);
+    dest.field(kKey, string_view_t(buf_.data(), buf_.size()));
+}
+
+SPDLOG_INLINE field_plan pattern_populator::plan() const
+{
+    return field_plan(field_kind::pattern, &kKey);
 }
 
 SPDLOG_INLINE std::unique_ptr<populator> pattern_populator::clone() const
@@ -34,14 +56,64 @@ SPDLOG_INLINE std::unique_ptr<populator> pattern_populator::clone() const
     return details::make_unique<pattern_populator>(*this);
 }
 
-SPDLOG_INLINE date_time_populator::date_time_populator()
-    : pattern_populator("date_time", "%Y-%m-%d %H:%M:%S.%e%z")
+SPDLOG_INLINE date_time_populator::date_time_populator(timestamp_format format, pattern_time_type time_type)
+    : kKey("date_time")
+    , renderer_(format, time_type)
 {}
 
+SPDLOG_INLINE void date_time_populator::populate(const details::log_msg &msg, nlohmann::json &dest)
+{
+    if (renderer_.format() == timestamp_format::epoch_micros)
+    {
+        dest[kKey.name()] = details::timestamp_renderer::epoch_micros(msg.time);
+        return;
+    }
+    buf_.clear();
+    renderer_.render(msg.time, buf_);
+    dest[kKey.name()] = std::string(buf_.data(), buf_.size());
+}
+
+SPDLOG_INLINE void date_time_populator::write(const details::log_msg &msg, json_writer &dest)
+{
+    if (renderer_.format() == timestamp_format::epoch_micros)
+    {
+        dest.field(kKey, details::timestamp_renderer::epoch_micros(msg.time));
+        return;
+    }
+    buf_.clear();
+    renderer_.render(msg.time, buf_);
+    dest.field(kKey, string_view_t(buf_.data(), buf_.size()));
+}
+
+SPDLOG_INLINE field_plan date_time_populator::plan() const
+{
+    return field_plan(field_kind::date_time, &kKey);
+}
+
+SPDLOG_INLINE std::unique_ptr<populator> date_time_populator::clone() const
+{
+    return details::make_unique<date_time_populator>(renderer_.format(), renderer_.time_type());
+}
+
 SPDLOG_INLINE level_populator::level_populator()
     : pattern_populator("level", "%l")
 {}
 
+SPDLOG_INLINE void level_populator::write(const details::log_msg &msg, json_writer &dest)
+{
+    dest.field(kKey, level::to_string_view(msg.level));
+}
+
+SPDLOG_INLINE field_plan level_populator::plan() const
+{
+    return field_plan(field_kind::level, &kKey);
+}
+
+SPDLOG_INLINE std::unique_ptr<populator> level_populator::clone() const
+{
+    return details::make_unique<level_populator>(*this);
+}
+
 SPDLOG_INLINE logger_name_populator::logger_name_populator()
     : pattern_populator("logger_name", "%n")
 {}
@@ -51,10 +123,23 @@ SPDLOG_INLINE void logger_name_populator::populate(const details::log_msg &msg,
     memory_buf_t tmp;
     pf_->format(msg, tmp);
     if (tmp.size() > 0) {
-        dest[kKey] = std::string(tmp.data(), tmp.size());
+        dest[kKey.name()] = std::string(tmp.data(), tmp.size());
+    }
+}
+
+SPDLOG_INLINE void logger_name_populator::write(const details::log_msg &msg, json_writer &dest)
+{
+    if (msg.logger_name.size() > 0)
+    {
+        dest.field(kKey, msg.logger_name);
     }
 }
 
+SPDLOG_INLINE field_plan logger_name_populator::plan() const
+{
+    return field_plan(field_kind::logger_name, &kKey);
+}
+
 SPDLOG_INLINE std::unique_ptr<populator> logger_name_populator::clone() const
 {
     return details::make_unique<logger_name_populator>(*this);
@@ -64,9 +149,38 @@ SPDLOG_INLINE message_populator::message_populator()
     : pattern_populator("message", "%v")
 {}
 
+SPDLOG_INLINE void message_populator::write(const details::log_msg &msg, json_writer &dest)
+{
+    dest.field(kKey, msg.payload);
+}
+
+SPDLOG_INLINE field_plan message_populator::plan() const
+{
+    return field_plan(field_kind::message, &kKey);
+}
+
+SPDLOG_INLINE std::unique_ptr<populator> message_populator::clone() const
+{
+    return details::make_unique<message_populator>(*this);
+}
+
+SPDLOG_INLINE pid_populator::pid_populator()
+    : kKey("pid")
+{}
+
 SPDLOG_INLINE void pid_populator::populate(const details::log_msg &, nlohmann::json &dest)
 {
-    dest["pid"] = details::os::pid();
+    dest[kKey.name()] = details::os::pid();
+}
+
+SPDLOG_INLINE void pid_populator::write(const details::log_msg &, json_writer &dest)
+{
+    dest.field(kKey, details::os::pid());
+}
+
+SPDLOG_INLINE field_plan pid_populator::plan() const
+{
+    return field_plan(field_kind::pid, &kKey);
 }
 
 SPDLOG_INLINE std::unique_ptr<populator> pid_populator::clone() const
@@ -78,9 +192,23 @@ SPDLOG_INLINE src_loc_populator::src_loc_populator()
     : pattern_populator("src_loc", "%@")
 {}
 
+SPDLOG_INLINE thread_id_populator::thread_id_populator()
+    : kKey("thread_id")
+{}
+
 SPDLOG_INLINE void thread_id_populator::populate(const details::log_msg &msg, nlohmann::json &dest)
 {
-    dest["thread_id"] = msg.thread_id;
+    dest[kKey.name()] = msg.thread_id;
+}
+
+SPDLOG_INLINE void thread_id_populator::write(const details::log_msg &msg, json_writer &dest)
+{
+    dest.field(kKey, msg.thread_id);
+}
+
+SPDLOG_INLINE field_plan thread_id_populator::plan() const
+{
+    return field_plan(field_kind::thread_id, &kKey);
 }
 
 SPDLOG_INLINE std::unique_ptr<populator> thread_id_populator::clone() const
@@ -88,10 +216,25 @@ SPDLOG_INLINE std::unique_ptr<populator> thread_id_populator::clone() const
     return details::make_unique<thread_id_populator>();
 }
 
+SPDLOG_INLINE timestamp_populator::timestamp_populator()
+    : kKey("timestamp")
+{}
+
 SPDLOG_INLINE void timestamp_populator::populate(const details::log_msg &msg, nlohmann::json &dest)
 {
     const auto dur = msg.time.time_since_epoch();
-    dest["timestamp"] = std::chrono::duration_cast<std::chrono::seconds>(dur).count();
+    dest[kKey.name()] = std::chrono::duration_cast<std::chrono::seconds>(dur).count();
+}
+
+SPDLOG_INLINE void timestamp_populator::write(const details::log_msg &msg, json_writer &dest)
+{
+    const auto dur = msg.time.time_since_epoch();
+    dest.field(kKey, std::chrono::duration_cast<std::chrono::seconds>(dur).count());
+}
+
+SPDLOG_INLINE field_plan timestamp_populator::plan() const
+{
+    return field_plan(field_kind::timestamp, &kKey);
 }
 
 SPDLOG_INLINE std::unique_ptr<populator> timestamp_populator::clone() const
@@ -6,15 +6,46 @@
 
 #include <spdlog/details/log_msg.h>
 #include <spdlog/details/os.h>
+#include <spdlog/details/timestamp_renderer.h>
 #include <spdlog/json.h>
+#include <spdlog/json_writer.h>
 #include <spdlog/pattern_formatter.h>
 
-#include <unordered_set>
+#include <cstdint>
+#include <vector>
 
 namespace spdlog {
 
 namespace populators {
 
+// what json_formatter's plan does for a populator (see json_formatter::format_stream_).
+// custom - call populator::write(). the others are written by the plan itself, without a virtual call.
+enum class field_kind : uint8_t
+{
+    custom,
+    pattern,
+    date_time,
+    level,
+    logger_name,
+    message,
+    pid,
+    thread_id,
+    timestamp
+};
+
+struct field_plan
+{
+    field_plan() = default;
+    field_plan(field_kind kind_, const json_key *key_)
+        : kind(kind_)
+        , key(key_)
+    {}
+
+    field_kind kind = field_kind::custom;
+    // the pre-rendered key of the field (null for custom)
+    const json_key *key = nullptr;
+};
+
 class SPDLOG_API populator
 {
 public:
@@ -22,16 +53,30 @@ public:
 
     virtual void populate(const details::log_msg &msg, nlohmann::json &dest) = 0;
 
+    // write the fields of this populator straight to the output.
+    // the default implementation populates a temporary object and writes its fields,
+    // override it to avoid building the temporary object.
+    virtual void write(const details::log_msg &msg, json_writer &dest);
+
+    // how json_formatter writes the field of this populator. the built-in populators return their
+    // own kind, so a class deriving from one of them and changing its output must return field_plan().
+    virtual field_plan plan() const
+    {
+        return field_plan();
+    }
+
     virtual std::unique_ptr<populator> clone() const = 0;
 };
 
 class SPDLOG_API pattern_populator : public populator
 {
 protected:
-    const std::string kKey;
+    const json_key kKey;
 
     std::unique_ptr<spdlog::formatter> pf_;
 
+    memory_buf_t buf_;
+
 public:
     pattern_populator(const std::string &key, const std::string &pattern);
 
@@ -39,19 +84,45 @@ public:
 
     virtual void populate(const details::log_msg &msg, nlohmann::json &dest) override;
 
+    virtual void write(const details::log_msg &msg, json_writer &dest) override;
+
+    virtual field_plan plan() const override;
+
     virtual std::unique_ptr<populator> clone() const override;
 };
 
-class SPDLOG_API date_time_populator : public pattern_populator
+class SPDLOG_API date_time_populator : public populator
 {
+private:
+    const json_key kKey;
+
+    details::timestamp_renderer renderer_;
+
+    memory_buf_t buf_;
+
 public:
-    date_time_populator();
+    explicit date_time_populator(
+        timestamp_format format = timestamp_format::date_time, pattern_time_type time_type = pattern_time_type::local);
+
+    virtual void populate(const details::log_msg &msg, nlohmann::json &dest) override;
+
+    virtual void write(const details::log_msg &msg, json_writer &dest) override;
+
+    virtual field_plan plan() const override;
+
+    virtual std::unique_ptr<populator> clone() const override;
 };
 
 class SPDLOG_API level_populator : public pattern_populator
 {
 public:
     level_populator();
+
+    virtual void write(const details::log_msg &msg, json_writer &dest) override;
+
+    virtual field_plan plan() const override;
+
+    virtual std::unique_ptr<populator> clone() const override;
 };
 
 class SPDLOG_API logger_name_populator : public pattern_populator
@@ -61,6 +132,10 @@ public:
 
     virtual void populate(const details::log_msg &msg, nlohmann::json &dest) override;
 
+    virtual void write(const details::log_msg &msg, json_writer &dest) override;
+
+    virtual field_plan plan() const override;
+
     virtual std::unique_ptr<populator> clone() const override;
 };
 
@@ -68,13 +143,28 @@ class SPDLOG_API message_populator : public pattern_populator
 {
 public:
     message_populator();
+
+    virtual void write(const details::log_msg &msg, json_writer &dest) override;
+
+    virtual field_plan plan() const override;
+
+    virtual std::unique_ptr<populator> clone() const override;
 };
 
 class SPDLOG_API pid_populator : public populator
 {
+private:
+    const json_key kKey;
+
 public:
+    pid_populator();
+
     virtual void populate(const details::log_msg &, nlohmann::json &dest) override;
 
+    virtual void write(const details::log_msg &, json_writer &dest) override;
+
+    virtual field_plan plan() const override;
+
     virtual std::unique_ptr<populator> clone() const override;
 };
 
@@ -86,21 +176,80 @@ public:
 
 class SPDLOG_API thread_id_populator : public populator
 {
+private:
+    const json_key kKey;
+
 public:
+    thread_id_populator();
+
     virtual void populate(const details::log_msg &msg, nlohmann::json &dest) override;
 
+    virtual void write(const details::log_msg &msg, json_writer &dest) override;
+
+    virtual field_plan plan() const override;
+
     virtual std::unique_ptr<populator> clone() const override;
 };
 
 class SPDLOG_API timestamp_populator : public populator
 {
+private:
+    const json_key kKey;
+
 public:
+    timestamp_populator();
+
     virtual void populate(const details::log_msg &msg, nlohmann::json &dest) override;
 
+    virtual void write(const details::log_msg &msg, json_writer &dest) override;
+
+    virtual field_plan plan() const override;
+
     virtual std::unique_ptr<populator> clone() const override;
 };
 
-typedef std::unordered_set<std::unique_ptr<populator>> populator_set;
+// Populators of a json_formatter, kept in insertion order.
+// The stream serializer writes their fields in that order.
+// (this used to be a std::unordered_set: insert() and iteration work as they did.)
+class populator_set
+{
+public:
+    using container_type = std::vector<std::unique_ptr<populator>>;
+    using const_iterator = container_type::const_iterator;
+
+    void insert(std::unique_ptr<populator> p)
+    {
+        populators_.push_back(std::move(p));
+    }
+
+    const_iterator begin() const
+    {
+        return populators_.begin();
+    }
+
+    const_iterator end() const
+    {
+        return populators_.end();
+    }
+
+    size_t size() const
+    {
+        return populators_.size();
+    }
+
+    bool empty() const
+    {
+        return populators_.empty();
+    }
+
+    void clear()
+    {
+        populators_.clear();
+    }
+
+private:
+    container_type populators_;
+};
 
 template<class... Args>
 populator_set make_populator_set(Args &&... args)
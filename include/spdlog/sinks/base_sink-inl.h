@@ -11,6 +11,7 @@
 #include <spdlog/pattern_formatter.h>
 #include <spdlog/default_formatter.h>
 
+#include <chrono>
 #include <memory>
 
 template<typename Mutex>
@@ -27,14 +28,40 @@ template<typename Mutex>
 void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::log(const details::log_msg &msg)
 {
     std::lock_guard<Mutex> lock(mutex_);
-    sink_it_(msg);
+    // reading the clock costs about as much as a whole write to a fast sink, so only some writes are timed
+    const auto seq = metrics_.messages.load(std::memory_order_relaxed);
+    if (seq % SPDLOG_SINK_LATENCY_SAMPLE_RATE != 0)
+    {
+        sink_it_(msg);
+    }
+    else
+    {
+        auto start = std::chrono::steady_clock::now();
+        sink_it_(msg);
+        metrics_.write_latency.record(std::chrono::steady_clock::now() - start);
+    }
+    metrics_.messages.store(seq + 1, std::memory_order_relaxed);
+}
+
+template<typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::log_batch(details::span<const details::log_msg *const> msgs, size_t &logged)
+{
+    std::lock_guard<Mutex> lock(mutex_);
+    auto start = std::chrono::steady_clock::now();
+    logged = 0;
+    sink_batch_(msgs, logged);
+    metrics_.write_latency.record(std::chrono::steady_clock::now() - start);
+    metrics_.messages.store(metrics_.messages.load(std::memory_order_relaxed) + msgs.size(), std::memory_order_relaxed);
 }
 
 template<typename Mutex>
 void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::flush()
 {
     std::lock_guard<Mutex> lock(mutex_);
+    auto start = std::chrono::steady_clock::now();
     flush_();
+    metrics_.flush_latency.record(std::chrono::steady_clock::now() - start);
+    metrics_.flushes.store(metrics_.flushes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
 }
 
 template<typename Mutex>
@@ -51,6 +78,15 @@ void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::set_formatter(std::unique_pt
     set_formatter_(std::move(sink_formatter));
 }
 
+template<typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::sink_batch_(details::span<const details::log_msg *const> msgs, size_t &logged)
+{
+    for (; logged < msgs.size(); ++logged)
+    {
+        sink_it_(*msgs[logged]);
+    }
+}
+
 template<typename Mutex>
 void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::set_pattern_(const std::string &pattern)
 {
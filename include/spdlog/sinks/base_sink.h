@@ -11,8 +11,15 @@
 
 #include <spdlog/common.h>
 #include <spdlog/details/log_msg.h>
+#include <spdlog/details/metrics.h>
 #include <spdlog/sinks/sink.h>
 
+// one in this many single message writes is timed in metrics().write_latency.
+// batches (see log_batch()) and flushes are always timed.
+#ifndef SPDLOG_SINK_LATENCY_SAMPLE_RATE
+#    define SPDLOG_SINK_LATENCY_SAMPLE_RATE 16
+#endif
+
 namespace spdlog {
 namespace sinks {
 template<typename Mutex>
@@ -30,16 +37,28 @@ public:
     base_sink &operator=(base_sink &&) = delete;
 
     void log(const details::log_msg &msg) final;
+    void log_batch(details::span<const details::log_msg *const> msgs, size_t &logged) final;
     void flush() final;
     void set_pattern(const std::string &pattern) final;
     void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) final;
 
+    // counters of this sink, readable from any thread without locking it.
+    const details::sink_metrics &metrics() const
+    {
+        return metrics_;
+    }
+
 protected:
     // sink formatter
     std::unique_ptr<spdlog::formatter> formatter_;
     Mutex mutex_;
+    // implementations add the bytes they write (metrics_.add_bytes()), the rest is counted here.
+    details::sink_metrics metrics_;
 
     virtual void sink_it_(const details::log_msg &msg) = 0;
+    // called with the mutex held. the default implementation calls sink_it_() for each message.
+    // implementations keep logged up to date with the number of messages written, see sink::log_batch().
+    virtual void sink_batch_(details::span<const details::log_msg *const> msgs, size_t &logged);
     virtual void flush_() = 0;
     virtual void set_pattern_(const std::string &pattern);
     virtual void set_formatter_(std::unique_ptr<spdlog::formatter> sink_formatter);
@@ -14,7 +14,8 @@ namespace spdlog {
 namespace sinks {
 
 template<typename Mutex>
-SPDLOG_INLINE basic_file_sink<Mutex>::basic_file_sink(const filename_t &filename, bool truncate)
+SPDLOG_INLINE basic_file_sink<Mutex>::basic_file_sink(const filename_t &filename, bool truncate, const file_options &options)
+    : file_helper_{options}
 {
     file_helper_.open(filename, truncate);
 }
@@ -31,6 +32,22 @@ SPDLOG_INLINE void basic_file_sink<Mutex>::sink_it_(const details::log_msg &msg)
     memory_buf_t formatted;
     base_sink<Mutex>::formatter_->format(msg, formatted);
     file_helper_.write(formatted);
+    base_sink<Mutex>::metrics_.add_bytes(formatted.size());
+}
+
+// format every message of the batch into the same buffer, and hand it to the (buffered) file helper.
+// a message counts as logged once written, so that a failed write is retried from the message it failed on.
+template<typename Mutex>
+SPDLOG_INLINE void basic_file_sink<Mutex>::sink_batch_(details::span<const details::log_msg *const> msgs, size_t &logged)
+{
+    memory_buf_t formatted;
+    for (; logged < msgs.size(); ++logged)
+    {
+        formatted.clear();
+        base_sink<Mutex>::formatter_->format(*msgs[logged], formatted);
+        file_helper_.write(formatted);
+        base_sink<Mutex>::metrics_.add_bytes(formatted.size());
+    }
 }
 
 template<typename Mutex>
@@ -14,17 +14,19 @@
 namespace spdlog {
 namespace sinks {
 /*
- * Trivial file sink with single file as target
+ * Trivial file sink with single file as target.
+ * The file_options select how the file is written (see details::file_helper).
  */
 template<typename Mutex>
 class basic_file_sink final : public base_sink<Mutex>
 {
 public:
-    explicit basic_file_sink(const filename_t &filename, bool truncate = false);
+    explicit basic_file_sink(const filename_t &filename, bool truncate = false, const file_options &options = {});
     const filename_t &filename() const;
 
 protected:
     void sink_it_(const details::log_msg &msg) override;
+    void sink_batch_(details::span<const details::log_msg *const> msgs, size_t &logged) override;
     void flush_() override;
 
 private:
@@ -40,15 +42,17 @@ using basic_file_sink_st = basic_file_sink<details::null_mutex>;
 // factory functions
 //
 template<typename Factory = spdlog::synchronous_factory>
-inline std::shared_ptr<logger> basic_logger_mt(const std::string &logger_name, const filename_t &filename, bool truncate = false)
+inline std::shared_ptr<logger> basic_logger_mt(
+    const std::string &logger_name, const filename_t &filename, bool truncate = false, const file_options &options = {})
 {
-    return Factory::template create<sinks::basic_file_sink_mt>(logger_name, filename, truncate);
+    return Factory::template create<sinks::basic_file_sink_mt>(logger_name, filename, truncate, options);
 }
 
 template<typename Factory = spdlog::synchronous_factory>
-inline std::shared_ptr<logger> basic_logger_st(const std::string &logger_name, const filename_t &filename, bool truncate = false)
+inline std::shared_ptr<logger> basic_logger_st(
+    const std::string &logger_name, const filename_t &filename, bool truncate = false, const file_options &options = {})
 {
-    return Factory::template create<sinks::basic_file_sink_st>(logger_name, filename, truncate);
+    return Factory::template create<sinks::basic_file_sink_st>(logger_name, filename, truncate, options);
 }
 
 } // namespace spdlog
@@ -0,0 +1,496 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifdef _WIN32
+#    error batching_tcp_sink is only available on posix systems
+#endif
+
+#include <spdlog/common.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/synchronous_factory.h>
+#include <spdlog/sinks/base_sink.h>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// TCP sink shipping the logs to a collector as NDJSON: one record per line,
+// as the json formatter writes them (a newline is added if missing).
+// Unlike tcp_sink, logging never waits for the network: the messages are
+// appended to a buffer that a dedicated I/O thread sends in batches, over a
+// non-blocking socket it connects (and reconnects, with exponential backoff) itself.
+// While the collector is slow or unreachable, up to max_buffer_size bytes are
+// kept, and the messages beyond that are dropped and counted.
+// A record cut by a lost connection is sent again from its start once reconnected.
+
+namespace spdlog {
+namespace sinks {
+
+struct batching_tcp_sink_config
+{
+    std::string server_host;
+    int server_port;
+    // send once batch_size bytes are waiting, or once the oldest waiting message is batch_interval old.
+    std::size_t batch_size = 64 * 1024;
+    std::chrono::milliseconds batch_interval{100};
+    // bytes kept, waiting or being sent. messages which do not fit are dropped.
+    std::size_t max_buffer_size = 8 * 1024 * 1024;
+    // delay before reconnecting, doubled after each failed attempt up to reconnect_max_delay.
+    std::chrono::milliseconds reconnect_min_delay{100};
+    std::chrono::milliseconds reconnect_max_delay{30 * 1000};
+    // how long the destructor keeps trying to send what is left.
+    std::chrono::milliseconds close_timeout{1000};
+
+    batching_tcp_sink_config(std::string host, int port)
+        : server_host{std::move(host)}
+        , server_port{port}
+    {}
+};
+
+template<typename Mutex>
+class batching_tcp_sink final : public base_sink<Mutex>
+{
+public:
+    // the connection is made by the I/O thread, so an unreachable collector does not throw.
+    explicit batching_tcp_sink(batching_tcp_sink_config config)
+        : config_{std::move(config)}
+    {
+        if (::pipe(wakeup_pipe_) != 0)
+        {
+            throw_spdlog_ex("batching_tcp_sink: pipe failed", errno);
+        }
+        for (int fd : wakeup_pipe_)
+        {
+            ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+            ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+        io_thread_ = std::thread([this] { io_loop_(); });
+    }
+
+    // try to send what is left for up to close_timeout, then stop the I/O thread.
+    ~batching_tcp_sink() override
+    {
+        {
+            std::lock_guard<std::mutex> lock(buffer_mutex_);
+            stopping_ = true;
+        }
+        wakeup_();
+        io_thread_.join();
+        close_socket_();
+        ::close(wakeup_pipe_[0]);
+        ::close(wakeup_pipe_[1]);
+    }
+
+    batching_tcp_sink(const batching_tcp_sink &) = delete;
+    batching_tcp_sink &operator=(const batching_tcp_sink &) = delete;
+
+    // messages (and their bytes) dropped because the buffer was full, or still unsent when the sink closed.
+    uint64_t dropped_messages() const
+    {
+        return dropped_messages_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t dropped_bytes() const
+    {
+        return dropped_bytes_.load(std::memory_order_relaxed);
+    }
+
+    // number of successful connections
+    uint64_t connects() const
+    {
+        return connects_.load(std::memory_order_relaxed);
+    }
+
+    bool is_connected() const
+    {
+        return connected_.load(std::memory_order_relaxed);
+    }
+
+protected:
+    void sink_it_(const details::log_msg &msg) override
+    {
+        formatted_.clear();
+        base_sink<Mutex>::formatter_->format(msg, formatted_);
+        if (formatted_.size() == 0 || formatted_[formatted_.size() - 1] != '\n')
+        {
+            formatted_.push_back('\n');
+        }
+
+        bool wake = false;
+        {
+            std::lock_guard<std::mutex> lock(buffer_mutex_);
+            if (pending_.size() + sending_size_ + formatted_.size() > config_.max_buffer_size)
+            {
+                dropped_messages_.store(dropped_messages_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                dropped_bytes_.store(dropped_bytes_.load(std::memory_order_relaxed) + formatted_.size(), std::memory_order_relaxed);
+                return;
+            }
+            // the I/O thread is woken to start the batch timer, and when the batch is full
+            bool first = pending_.size() == 0;
+            if (first)
+            {
+                oldest_tp_ = std::chrono::steady_clock::now();
+            }
+            pending_.append(formatted_.data(), formatted_.data() + formatted_.size());
+            if ((first || pending_.size() >= config_.batch_size) && !wakeup_pending_)
+            {
+                wakeup_pending_ = true;
+                wake = true;
+            }
+        }
+        if (wake)
+        {
+            wakeup_();
+        }
+        base_sink<Mutex>::metrics_.add_bytes(formatted_.size());
+    }
+
+    // have the I/O thread send what is waiting now. does not wait for it to be sent.
+    void flush_() override
+    {
+        bool wake = false;
+        {
+            std::lock_guard<std::mutex> lock(buffer_mutex_);
+            flush_requested_ = true;
+            if (!wakeup_pending_)
+            {
+                wakeup_pending_ = true;
+                wake = true;
+            }
+        }
+        if (wake)
+        {
+            wakeup_();
+        }
+    }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    batching_tcp_sink_config config_;
+    // reused for every message
+    memory_buf_t formatted_;
+
+    // shared with the I/O thread, guarded by buffer_mutex_
+    std::mutex buffer_mutex_;
+    memory_buf_t pending_;
+    clock::time_point oldest_tp_;
+    size_t sending_size_{0};
+    bool flush_requested_{false};
+    bool wakeup_pending_{false};
+    bool stopping_{false};
+
+    std::atomic<uint64_t> dropped_messages_{0};
+    std::atomic<uint64_t> dropped_bytes_{0};
+    std::atomic<uint64_t> connects_{0};
+    std::atomic<bool> connected_{false};
+
+    // I/O thread only
+    int socket_{-1};
+    bool connecting_{false};
+    memory_buf_t sending_;
+    size_t sent_{0};
+    clock::time_point next_connect_tp_;
+    std::chrono::milliseconds reconnect_delay_{0};
+
+    int wakeup_pipe_[2] = {-1, -1};
+    std::thread io_thread_;
+
+    void wakeup_()
+    {
+        char byte = 0;
+        // a full pipe already holds a wakeup
+        if (::write(wakeup_pipe_[1], &byte, 1) < 0)
+        {}
+    }
+
+    void io_loop_()
+    {
+        reconnect_delay_ = config_.reconnect_min_delay;
+        next_connect_tp_ = clock::now();
+        auto stop_deadline = clock::time_point::max();
+        for (;;)
+        {
+            auto now = clock::now();
+            auto batch_deadline = clock::time_point::max();
+            bool stopping;
+            bool pending_empty;
+            {
+                std::lock_guard<std::mutex> lock(buffer_mutex_);
+                wakeup_pending_ = false;
+                stopping = stopping_;
+                // take the next batch once the previous one is sent and this one is due
+                if (sent_ == sending_.size() && pending_.size() > 0)
+                {
+                    if (pending_.size() >= config_.batch_size || now - oldest_tp_ >= config_.batch_interval || flush_requested_ || stopping)
+                    {
+                        sending_.clear();
+                        sent_ = 0;
+                        std::swap(sending_, pending_);
+                        sending_size_ = sending_.size();
+                        flush_requested_ = false;
+                    }
+                    else
+                    {
+                        batch_deadline = oldest_tp_ + config_.batch_interval;
+                    }
+                }
+                pending_empty = pending_.size() == 0;
+            }
+
+            bool done_sending = sent_ == sending_.size() && pending_empty;
+            if (stopping)
+            {
+                if (stop_deadline == clock::time_point::max())
+                {
+                    stop_deadline = now + config_.close_timeout;
+                }
+                if (done_sending || now >= stop_deadline)
+                {
+                    break;
+                }
+            }
+
+            if (socket_ == -1 && now >= next_connect_tp_)
+            {
+                connect_();
+            }
+            if (socket_ != -1 && !connecting_ && sent_ < sending_.size())
+            {
+                send_();
+            }
+
+            // wait for a wakeup, the socket, or the next deadline
+            pollfd fds[2];
+            fds[0].fd = wakeup_pipe_[0];
+            fds[0].events = POLLIN;
+            fds[0].revents = 0;
+            nfds_t nfds = 1;
+            if (socket_ != -1)
+            {
+                fds[1].fd = socket_;
+                fds[1].events = static_cast<short>(POLLIN | (connecting_ || sent_ < sending_.size() ? POLLOUT : 0));
+                fds[1].revents = 0;
+                nfds = 2;
+            }
+            auto deadline = (std::min)(batch_deadline, stop_deadline);
+            if (socket_ == -1)
+            {
+                deadline = (std::min)(deadline, next_connect_tp_);
+            }
+            int timeout_ms = -1;
+            if (deadline != clock::time_point::max())
+            {
+                auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - clock::now()).count() + 1;
+                timeout_ms = static_cast<int>((std::max)(wait, decltype(wait){0}));
+            }
+            if (::poll(fds, nfds, timeout_ms) <= 0)
+            {
+                continue;
+            }
+
+            if (fds[0].revents != 0)
+            {
+                char drain[64];
+                while (::read(wakeup_pipe_[0], drain, sizeof(drain)) > 0)
+                {}
+            }
+            if (nfds == 2 && fds[1].revents != 0)
+            {
+                handle_socket_event_(fds[1].revents);
+            }
+        }
+
+        // what could not be sent is lost
+        uint64_t unsent_messages = 0;
+        uint64_t unsent_bytes = 0;
+        {
+            std::lock_guard<std::mutex> lock(buffer_mutex_);
+            unsent_bytes = (sending_.size() - sent_) + pending_.size();
+            unsent_messages = static_cast<uint64_t>(std::count(sending_.begin() + static_cast<std::ptrdiff_t>(sent_), sending_.end(), '\n') +
+                                                    std::count(pending_.begin(), pending_.end(), '\n'));
+        }
+        dropped_messages_.fetch_add(unsent_messages, std::memory_order_relaxed);
+        dropped_bytes_.fetch_add(unsent_bytes, std::memory_order_relaxed);
+    }
+
+    // start a non-blocking connection to the collector
+    void connect_()
+    {
+        addrinfo hints;
+        std::memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_NUMERICSERV;
+        addrinfo *result = nullptr;
+        if (::getaddrinfo(config_.server_host.c_str(), std::to_string(config_.server_port).c_str(), &hints, &result) != 0)
+        {
+            connection_failed_();
+            return;
+        }
+        socket_ = ::socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+        if (socket_ != -1)
+        {
+            ::fcntl(socket_, F_SETFL, ::fcntl(socket_, F_GETFL) | O_NONBLOCK);
+            ::fcntl(socket_, F_SETFD, FD_CLOEXEC);
+            int enable_flag = 1;
+            ::setsockopt(socket_, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<char *>(&enable_flag), sizeof(enable_flag));
+#if defined(SO_NOSIGPIPE) && !defined(MSG_NOSIGNAL)
+            ::setsockopt(socket_, SOL_SOCKET, SO_NOSIGPIPE, reinterpret_cast<char *>(&enable_flag), sizeof(enable_flag));
+#endif
+        }
+        int rv = socket_ == -1 ? -1 : ::connect(socket_, result->ai_addr, result->ai_addrlen);
+        ::freeaddrinfo(result);
+        if (rv == 0)
+        {
+            connected_now_();
+        }
+        else if (socket_ != -1 && errno == EINPROGRESS)
+        {
+            connecting_ = true;
+        }
+        else
+        {
+            connection_failed_();
+        }
+    }
+
+    void handle_socket_event_(short revents)
+    {
+        if (connecting_)
+        {
+            int error = 0;
+            socklen_t len = sizeof(error);
+            if (::getsockopt(socket_, SOL_SOCKET, SO_ERROR, &error, &len) != 0 || error != 0)
+            {
+                connection_failed_();
+                return;
+            }
+            connecting_ = false;
+            connected_now_();
+            return;
+        }
+        if ((revents & (POLLERR | POLLHUP)) != 0)
+        {
+            connection_failed_();
+            return;
+        }
+        if ((revents & POLLIN) != 0)
+        {
+            // the collector is not expected to answer: discard, and notice when it closes
+            char discard[512];
+            auto rv = ::recv(socket_, discard, sizeof(discard), 0);
+            if (rv == 0 || (rv < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+            {
+                connection_failed_();
+            }
+        }
+    }
+
+    void send_()
+    {
+#if defined(MSG_NOSIGNAL)
+        const int send_flags = MSG_NOSIGNAL;
+#else
+        const int send_flags = 0;
+#endif
+        while (sent_ < sending_.size())
+        {
+            auto rv = ::send(socket_, sending_.data() + sent_, sending_.size() - sent_, send_flags);
+            if (rv > 0)
+            {
+                sent_ += static_cast<size_t>(rv);
+                continue;
+            }
+            if (rv < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (rv < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                break;
+            }
+            connection_failed_();
+            return;
+        }
+        std::lock_guard<std::mutex> lock(buffer_mutex_);
+        sending_size_ = sending_.size() - sent_;
+    }
+
+    void connected_now_()
+    {
+        reconnect_delay_ = config_.reconnect_min_delay;
+        connects_.fetch_add(1, std::memory_order_relaxed);
+        connected_.store(true, std::memory_order_relaxed);
+    }
+
+    // close the socket, schedule the next attempt, and keep the unsent data from the start of its first record.
+    void connection_failed_()
+    {
+        close_socket_();
+        next_connect_tp_ = clock::now() + reconnect_delay_;
+        reconnect_delay_ = (std::min)(reconnect_delay_ * 2, config_.reconnect_max_delay);
+
+        if (sent_ > 0)
+        {
+            size_t record_start = sent_;
+            while (record_start > 0 && sending_[record_start - 1] != '\n')
+            {
+                record_start--;
+            }
+            std::copy(sending_.begin() + static_cast<std::ptrdiff_t>(record_start), sending_.end(), sending_.begin());
+            sending_.resize(sending_.size() - record_start);
+            sent_ = 0;
+            std::lock_guard<std::mutex> lock(buffer_mutex_);
+            sending_size_ = sending_.size();
+        }
+    }
+
+    void close_socket_()
+    {
+        if (socket_ != -1)
+        {
+            ::close(socket_);
+            socket_ = -1;
+        }
+        connecting_ = false;
+        connected_.store(false, std::memory_order_relaxed);
+    }
+};
+
+using batching_tcp_sink_mt = batching_tcp_sink<std::mutex>;
+using batching_tcp_sink_st = batching_tcp_sink<details::null_mutex>;
+
+} // namespace sinks
+
+//
+// factory functions
+//
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> batching_tcp_logger_mt(const std::string &logger_name, sinks::batching_tcp_sink_config config)
+{
+    return Factory::template create<sinks::batching_tcp_sink_mt>(logger_name, std::move(config));
+}
+
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> batching_tcp_logger_st(const std::string &logger_name, sinks::batching_tcp_sink_config config)
+{
+    return Factory::template create<sinks::batching_tcp_sink_st>(logger_name, std::move(config));
+}
+
+} // namespace spdlog
@@ -0,0 +1,147 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/details/file_helper.h>
+#include <spdlog/details/gzip_writer.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/synchronous_factory.h>
+#include <spdlog/sinks/base_sink.h>
+
+#include <exception>
+#include <mutex>
+#include <string>
+
+namespace spdlog {
+namespace sinks {
+/*
+ * File sink writing gzip compressed logs (requires zlib).
+ * The file is a sequence of gzip members of member_size uncompressed bytes,
+ * each of which can be decoded on its own (see details/gzip_writer.h).
+ * Appending to an existing file adds members to it, and zcat reads them all.
+ * flush() makes everything logged so far decodable, at a small cost in
+ * compression, so avoid flushing on every message.
+ */
+template<typename Mutex>
+class gzip_file_sink final : public base_sink<Mutex>
+{
+public:
+    explicit gzip_file_sink(
+        const filename_t &filename, bool truncate = false, size_t member_size = SPDLOG_GZIP_MEMBER_SIZE, int level = Z_DEFAULT_COMPRESSION)
+        : member_size_{member_size}
+        , writer_{level}
+    {
+        file_helper_.open(filename, truncate);
+    }
+
+    ~gzip_file_sink() override
+    {
+        SPDLOG_TRY
+        {
+            writer_.finish_member(compressed_);
+            write_compressed_();
+        }
+        SPDLOG_CATCH_STD
+    }
+
+    const filename_t &filename() const
+    {
+        return file_helper_.filename();
+    }
+
+protected:
+    void sink_it_(const details::log_msg &msg) override
+    {
+        formatted_.clear();
+        base_sink<Mutex>::formatter_->format(msg, formatted_);
+        compress_formatted_();
+    }
+
+    // compress the whole batch at once
+    void sink_batch_(details::span<const details::log_msg *const> msgs, size_t &logged) override
+    {
+        formatted_.clear();
+        for (auto *msg : msgs)
+        {
+            base_sink<Mutex>::formatter_->format(*msg, formatted_);
+        }
+        compress_formatted_();
+        logged = msgs.size();
+    }
+
+    void flush_() override
+    {
+        writer_.sync(compressed_);
+        write_compressed_();
+        file_helper_.flush();
+    }
+
+private:
+    size_t member_size_;
+    details::gzip_writer writer_;
+    details::file_helper file_helper_;
+    // reused for every message
+    memory_buf_t formatted_;
+    memory_buf_t compressed_;
+
+    void compress_formatted_()
+    {
+        writer_.write(formatted_.data(), formatted_.size(), compressed_);
+        if (writer_.member_bytes() >= member_size_)
+        {
+            writer_.finish_member(compressed_);
+        }
+        write_compressed_();
+    }
+
+    // metrics count the compressed bytes, i.e. what reaches the disk
+    void write_compressed_()
+    {
+        if (compressed_.size() == 0)
+        {
+            return;
+        }
+#ifndef SPDLOG_NO_EXCEPTIONS
+        try
+        {
+            file_helper_.write(compressed_);
+        }
+        catch (const std::exception &)
+        {
+            // written again, the bytes would corrupt the rest of the member: drop them, and the member
+            // with them, so that the next messages start a new member, readable on its own.
+            compressed_.clear();
+            writer_.abandon_member();
+            throw;
+        }
+#else
+        file_helper_.write(compressed_);
+#endif
+        base_sink<Mutex>::metrics_.add_bytes(compressed_.size());
+        compressed_.clear();
+    }
+};
+
+using gzip_file_sink_mt = gzip_file_sink<std::mutex>;
+using gzip_file_sink_st = gzip_file_sink<details::null_mutex>;
+
+} // namespace sinks
+
+//
+// factory functions
+//
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> gzip_logger_mt(const std::string &logger_name, const filename_t &filename, bool truncate = false)
+{
+    return Factory::template create<sinks::gzip_file_sink_mt>(logger_name, filename, truncate);
+}
+
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> gzip_logger_st(const std::string &logger_name, const filename_t &filename, bool truncate = false)
+{
+    return Factory::template create<sinks::gzip_file_sink_st>(logger_name, filename, truncate);
+}
+
+} // namespace spdlog
@@ -40,14 +40,16 @@ struct hourly_filename_calculator
  * Rotating file sink based on time.
  * If truncate != false , the created file will be truncated.
  * If max_files > 0, retain only the last max_files and delete previous.
+ * The file_options select how the files are written (see details::file_helper).
  */
 template<typename Mutex, typename FileNameCalc = hourly_filename_calculator>
 class hourly_file_sink final : public base_sink<Mutex>
 {
 public:
     // create hourly file sink which rotates on given time
-    hourly_file_sink(filename_t base_filename, bool truncate = false, uint16_t max_files = 0)
+    hourly_file_sink(filename_t base_filename, bool truncate = false, uint16_t max_files = 0, const file_options &options = {})
         : base_filename_(std::move(base_filename))
+        , file_helper_(options)
         , truncate_(truncate)
         , max_files_(max_files)
         , filenames_q_()
@@ -83,6 +85,7 @@ protected:
         memory_buf_t formatted;
         base_sink<Mutex>::formatter_->format(msg, formatted);
         file_helper_.write(formatted);
+        base_sink<Mutex>::metrics_.add_bytes(formatted.size());
 
         // Do the cleaning only at the end because it might throw on failure.
         if (should_rotate && max_files_ > 0)
@@ -180,15 +183,17 @@ using hourly_file_sink_st = hourly_file_sink<details::null_mutex>;
 //
 template<typename Factory = spdlog::synchronous_factory>
 inline std::shared_ptr<logger> hourly_logger_mt(
-    const std::string &logger_name, const filename_t &filename, bool truncate = false, uint16_t max_files = 0)
+    const std::string &logger_name, const filename_t &filename, bool truncate = false, uint16_t max_files = 0,
+    const file_options &options = {})
 {
-    return Factory::template create<sinks::hourly_file_sink_mt>(logger_name, filename, truncate, max_files);
+    return Factory::template create<sinks::hourly_file_sink_mt>(logger_name, filename, truncate, max_files, options);
 }
 
 template<typename Factory = spdlog::synchronous_factory>
 inline std::shared_ptr<logger> hourly_logger_st(
-    const std::string &logger_name, const filename_t &filename, bool truncate = false, uint16_t max_files = 0)
+    const std::string &logger_name, const filename_t &filename, bool truncate = false, uint16_t max_files = 0,
+    const file_options &options = {})
 {
-    return Factory::template create<sinks::hourly_file_sink_st>(logger_name, filename, truncate, max_files);
+    return Factory::template create<sinks::hourly_file_sink_st>(logger_name, filename, truncate, max_files, options);
 }
 } // namespace spdlog
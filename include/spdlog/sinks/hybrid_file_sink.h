@@ -0,0 +1,339 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/details/file_helper.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/os.h>
+#include <spdlog/details/synchronous_factory.h>
+#include <spdlog/details/task_worker.h>
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/sinks/base_sink.h>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace spdlog {
+namespace sinks {
+
+struct hybrid_file_sink_config
+{
+    filename_t base_filename;
+    // start a new file once the current one would grow past max_size bytes. 0: no size limit.
+    std::size_t max_size = 0;
+    // start a new file every rotation_interval, at multiples of it in local time
+    // (e.g. every hour on the hour, or every day at midnight). 0: no time limit.
+    std::chrono::seconds rotation_interval{0};
+    // delete the oldest files once the files, the current one included, could take
+    // more than max_total_size bytes (the current one counting as max_size). 0: no limit.
+    uint64_t max_total_size = 0;
+    // delete the files whose last message is older than max_age. 0: no limit.
+    std::chrono::seconds max_age{0};
+    file_options options;
+
+    explicit hybrid_file_sink_config(filename_t fname)
+        : base_filename{std::move(fname)}
+    {}
+};
+
+/*
+ * Rotating file sink based on both size and time: a new file is started when either limit is hit.
+ * The files are named after the time they were started and a sequence number,
+ * e.g. logs/app.log => logs/app_2024-01-31_13-00-00.17.log, and are never renamed,
+ * so a rotation costs the same whatever the number of files kept.
+ * The retention limits apply to the files of previous runs too, whose last message is
+ * dated by their modification time. They are checked on startup and on each rotation,
+ * and a worker thread deletes the expired files.
+ */
+template<typename Mutex>
+class hybrid_file_sink final : public base_sink<Mutex>
+{
+public:
+    explicit hybrid_file_sink(hybrid_file_sink_config config)
+        : config_(std::move(config))
+        , file_helper_(config_.options)
+    {
+        load_files_();
+        open_file_(log_clock::now());
+    }
+
+    // name of the file started at the given time, with the given sequence number
+    static filename_t calc_filename(const filename_t &filename, const tm &now_tm, uint64_t seq)
+    {
+        filename_t basename, ext;
+        std::tie(basename, ext) = details::file_helper::split_by_extension(filename);
+        return fmt::format(SPDLOG_FILENAME_T("{}_{:04d}-{:02d}-{:02d}_{:02d}-{:02d}-{:02d}.{}{}"), basename, now_tm.tm_year + 1900,
+            now_tm.tm_mon + 1, now_tm.tm_mday, now_tm.tm_hour, now_tm.tm_min, now_tm.tm_sec, seq, ext);
+    }
+
+    // the file being written
+    filename_t filename()
+    {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        return file_helper_.filename();
+    }
+
+protected:
+    void sink_it_(const details::log_msg &msg) override
+    {
+        formatted_.clear();
+        base_sink<Mutex>::formatter_->format(msg, formatted_);
+        bool size_exceeded = config_.max_size > 0 && current_size_ > 0 && current_size_ + formatted_.size() > config_.max_size;
+        if (size_exceeded || msg.time >= rotation_tp_)
+        {
+            rotate_(msg.time);
+        }
+        file_helper_.write(formatted_);
+        current_size_ += formatted_.size();
+        base_sink<Mutex>::metrics_.add_bytes(formatted_.size());
+    }
+
+    void flush_() override
+    {
+        file_helper_.flush();
+    }
+
+private:
+    struct file_info
+    {
+        filename_t filename;
+        uint64_t size;
+        // when the file was started
+        log_clock::time_point opened;
+        // when its last message was written
+        log_clock::time_point last_write;
+    };
+
+    hybrid_file_sink_config config_;
+    details::file_helper file_helper_;
+    // reused for every message
+    memory_buf_t formatted_;
+    uint64_t current_size_{0};
+    log_clock::time_point opened_;
+    log_clock::time_point rotation_tp_;
+    uint64_t next_seq_{0};
+    // the previous files, oldest first, and their total size
+    std::deque<file_info> files_;
+    uint64_t files_size_{0};
+    // last member, so that it is destroyed (and deletes the remaining expired files) first
+    details::task_worker worker_;
+
+    static tm now_tm(log_clock::time_point tp)
+    {
+        return details::os::localtime(log_clock::to_time_t(tp));
+    }
+
+    void rotate_(log_clock::time_point tp)
+    {
+        file_helper_.close();
+        // a file has no message newer than the start of the next one
+        files_.push_back(file_info{file_helper_.filename(), current_size_, opened_, tp});
+        files_size_ += current_size_;
+        open_file_(tp);
+
+        auto error = worker_.take_error();
+        if (!error.empty())
+        {
+            throw_spdlog_ex("hybrid_file_sink: failed deleting old files: " + error);
+        }
+    }
+
+    void open_file_(log_clock::time_point tp)
+    {
+        file_helper_.open(calc_filename(config_.base_filename, now_tm(tp), next_seq_++));
+        current_size_ = file_helper_.size();
+        opened_ = tp;
+        rotation_tp_ = next_rotation_tp_(tp);
+        delete_expired_(tp);
+    }
+
+    // the next multiple of the rotation interval in local time
+    log_clock::time_point next_rotation_tp_(log_clock::time_point tp) const
+    {
+        if (config_.rotation_interval.count() <= 0)
+        {
+            return log_clock::time_point::max();
+        }
+        auto offset = std::chrono::minutes(details::os::utc_minutes_offset(now_tm(tp)));
+        auto local = std::chrono::duration_cast<std::chrono::seconds>(tp.time_since_epoch() + offset);
+        auto interval = config_.rotation_interval.count();
+        auto next_local = std::chrono::seconds((local.count() / interval + 1) * interval);
+        return log_clock::time_point(std::chrono::duration_cast<log_clock::duration>(next_local - offset));
+    }
+
+    // drop the oldest files until the retention limits are met, and have the worker delete them.
+    void delete_expired_(log_clock::time_point now)
+    {
+        // leave room for the current file to reach max_size
+        uint64_t size_budget = config_.max_total_size > config_.max_size ? config_.max_total_size - config_.max_size : 0;
+        std::vector<filename_t> expired;
+        while (!files_.empty())
+        {
+            bool too_big = config_.max_total_size > 0 && files_size_ > size_budget;
+            bool too_old = config_.max_age.count() > 0 && now - files_.front().last_write > config_.max_age;
+            if (!too_big && !too_old)
+            {
+                break;
+            }
+            files_size_ -= files_.front().size;
+            expired.push_back(std::move(files_.front().filename));
+            files_.pop_front();
+        }
+
+        if (!expired.empty())
+        {
+            worker_.post([expired] {
+                for (auto &filename : expired)
+                {
+                    if (details::os::remove_if_exists(filename) != 0)
+                    {
+                        throw_spdlog_ex("failed removing " + details::os::filename_to_str(filename), errno);
+                    }
+                }
+            });
+        }
+    }
+
+    // find the files of the previous runs, and continue their sequence numbers.
+    void load_files_()
+    {
+        filename_t basename, ext;
+        std::tie(basename, ext) = details::file_helper::split_by_extension(config_.base_filename);
+        filename_t dir = details::os::dir_name(config_.base_filename);
+        filename_t prefix = basename.substr(dir.empty() ? 0 : dir.size() + 1) + SPDLOG_FILENAME_T("_");
+
+        std::vector<std::pair<uint64_t, file_info>> found;
+        for (auto &name : details::os::dir_entries(dir.empty() ? filename_t(SPDLOG_FILENAME_T(".")) : dir))
+        {
+            tm file_tm{};
+            uint64_t seq = 0;
+            if (!parse_filename_(name, prefix, ext, file_tm, seq))
+            {
+                continue;
+            }
+            auto path = dir.empty() ? name : dir + details::os::folder_seps_filename[0] + name;
+            found.emplace_back(seq, file_info{path, file_size_(path), log_clock::from_time_t(std::mktime(&file_tm)), file_mtime_(path)});
+            next_seq_ = (std::max)(next_seq_, seq + 1);
+        }
+
+        std::sort(found.begin(), found.end(),
+            [](const std::pair<uint64_t, file_info> &a, const std::pair<uint64_t, file_info> &b) { return a.first < b.first; });
+        for (auto &file : found)
+        {
+            files_size_ += file.second.size;
+            files_.push_back(std::move(file.second));
+        }
+    }
+
+    // parse a name like prefix2024-01-31_13-00-00.17ext
+    static bool parse_filename_(const filename_t &name, const filename_t &prefix, const filename_t &ext, tm &file_tm, uint64_t &seq)
+    {
+        const size_t time_len = 19; // 2024-01-31_13-00-00
+        if (name.size() < prefix.size() + time_len + 2 + ext.size() || name.compare(0, prefix.size(), prefix) != 0 ||
+            name.compare(name.size() - ext.size(), ext.size(), ext) != 0)
+        {
+            return false;
+        }
+        const size_t time_pos = prefix.size();
+        auto number = [&](size_t pos, size_t len, int &value) {
+            value = 0;
+            for (size_t i = pos; i < pos + len; i++)
+            {
+                if (name[i] < '0' || name[i] > '9')
+                {
+                    return false;
+                }
+                value = value * 10 + (name[i] - '0');
+            }
+            return true;
+        };
+        int year, month;
+        if (!number(time_pos, 4, year) || !number(time_pos + 5, 2, month) || !number(time_pos + 8, 2, file_tm.tm_mday) ||
+            !number(time_pos + 11, 2, file_tm.tm_hour) || !number(time_pos + 14, 2, file_tm.tm_min) ||
+            !number(time_pos + 17, 2, file_tm.tm_sec) || name[time_pos + time_len] != '.')
+        {
+            return false;
+        }
+        file_tm.tm_year = year - 1900;
+        file_tm.tm_mon = month - 1;
+        file_tm.tm_isdst = -1;
+
+        const size_t seq_pos = time_pos + time_len + 1;
+        const size_t seq_end = name.size() - ext.size();
+        seq = 0;
+        for (size_t i = seq_pos; i < seq_end; i++)
+        {
+            if (name[i] < '0' || name[i] > '9')
+            {
+                return false;
+            }
+            seq = seq * 10 + static_cast<uint64_t>(name[i] - '0');
+        }
+        return seq_end > seq_pos;
+    }
+
+    static uint64_t file_size_(const filename_t &filename)
+    {
+        std::FILE *file;
+        if (details::os::fopen_s(&file, filename, SPDLOG_FILENAME_T("rb")))
+        {
+            return 0;
+        }
+        uint64_t size = details::os::filesize(file);
+        std::fclose(file);
+        return size;
+    }
+
+    // the last modification time of the file, or now (keeping the file) if it cannot be read
+    static log_clock::time_point file_mtime_(const filename_t &filename)
+    {
+#ifdef _WIN32
+        struct _stat64 st;
+#    ifdef SPDLOG_WCHAR_FILENAMES
+        bool ok = ::_wstat64(filename.c_str(), &st) == 0;
+#    else
+        bool ok = ::_stat64(filename.c_str(), &st) == 0;
+#    endif
+#else
+        struct stat st;
+        bool ok = ::stat(filename.c_str(), &st) == 0;
+#endif
+        return ok ? log_clock::from_time_t(st.st_mtime) : log_clock::now();
+    }
+};
+
+using hybrid_file_sink_mt = hybrid_file_sink<std::mutex>;
+using hybrid_file_sink_st = hybrid_file_sink<details::null_mutex>;
+
+} // namespace sinks
+
+//
+// factory functions
+//
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> hybrid_logger_mt(const std::string &logger_name, sinks::hybrid_file_sink_config config)
+{
+    return Factory::template create<sinks::hybrid_file_sink_mt>(logger_name, std::move(config));
+}
+
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> hybrid_logger_st(const std::string &logger_name, sinks::hybrid_file_sink_config config)
+{
+    return Factory::template create<sinks::hybrid_file_sink_st>(logger_name, std::move(config));
+}
+
+} // namespace spdlog
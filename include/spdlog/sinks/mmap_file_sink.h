@@ -0,0 +1,149 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/details/file_helper.h>
+#include <spdlog/details/mmap_file.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/synchronous_factory.h>
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/sinks/base_sink.h>
+
+#include <cerrno>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+// File sink writing to a memory mapped file (posix only).
+// The file grows by preallocated segments of segment_size bytes, and records
+// are copied into the mapping: no system call per message, and no stdio lock
+// or buffer. The data is in the page cache as soon as it is written, so it is
+// visible to readers of the file and survives a crash of the process.
+// The file is truncated to the written size when the sink closes it. Until then,
+// the written size is also kept in filename + ".size", so that a file left by a
+// crash is reopened right after its data, binary output included.
+
+namespace spdlog {
+namespace sinks {
+
+struct mmap_file_sink_config
+{
+    filename_t filename;
+    bool truncate = false;
+    std::size_t segment_size = details::mmap_file::default_segment_size;
+    // rotate the file once it would grow past max_size bytes, keeping max_files
+    // previous ones (log.txt -> log.1.txt -> ...). 0 never rotates.
+    std::size_t max_size = 0;
+    std::size_t max_files = 0;
+
+    explicit mmap_file_sink_config(filename_t fname)
+        : filename{std::move(fname)}
+    {}
+};
+
+template<typename Mutex>
+class mmap_file_sink final : public base_sink<Mutex>
+{
+public:
+    explicit mmap_file_sink(mmap_file_sink_config config)
+        : config_{std::move(config)}
+    {
+        file_.open(config_.filename, config_.truncate, config_.segment_size);
+    }
+
+    const filename_t &filename() const
+    {
+        return file_.filename();
+    }
+
+    // the size of the current file, readable without locking the sink.
+    size_t size() const
+    {
+        return file_.size();
+    }
+
+protected:
+    void sink_it_(const details::log_msg &msg) override
+    {
+        formatted_.clear();
+        base_sink<Mutex>::formatter_->format(msg, formatted_);
+        if (config_.max_size > 0 && file_.size() > 0 && file_.size() + formatted_.size() > config_.max_size)
+        {
+            rotate_();
+        }
+        file_.write(formatted_);
+        base_sink<Mutex>::metrics_.add_bytes(formatted_.size());
+    }
+
+    void flush_() override
+    {
+        file_.flush();
+    }
+
+private:
+    mmap_file_sink_config config_;
+    details::mmap_file file_;
+    // reused for every message, so formatting does not allocate once it has grown
+    memory_buf_t formatted_;
+
+    // calc filename according to index and file extension if exists.
+    // e.g. calc_filename("logs/mylog.txt, 3) => "logs/mylog.3.txt".
+    static filename_t calc_filename_(const filename_t &filename, std::size_t index)
+    {
+        if (index == 0u)
+        {
+            return filename;
+        }
+
+        filename_t basename, ext;
+        std::tie(basename, ext) = details::file_helper::split_by_extension(filename);
+        return fmt::format(SPDLOG_FILENAME_T("{}.{}{}"), basename, index, ext);
+    }
+
+    // close (and so truncate) the file, shift the previous files as rotating_file_sink does, and start a new one.
+    void rotate_()
+    {
+        using details::os::filename_to_str;
+        file_.close();
+        for (auto i = config_.max_files; i > 0; --i)
+        {
+            filename_t src = calc_filename_(config_.filename, i - 1);
+            if (!details::os::path_exists(src))
+            {
+                continue;
+            }
+            filename_t target = calc_filename_(config_.filename, i);
+            (void)details::os::remove(target);
+            if (details::os::rename(src, target) != 0)
+            {
+                file_.reopen(true); // truncate the log file anyway to prevent it to grow beyond its limit!
+                throw_spdlog_ex("mmap_file_sink: failed renaming " + filename_to_str(src) + " to " + filename_to_str(target), errno);
+            }
+        }
+        file_.reopen(true);
+    }
+};
+
+using mmap_file_sink_mt = mmap_file_sink<std::mutex>;
+using mmap_file_sink_st = mmap_file_sink<details::null_mutex>;
+
+} // namespace sinks
+
+//
+// factory functions
+//
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> mmap_logger_mt(const std::string &logger_name, sinks::mmap_file_sink_config config)
+{
+    return Factory::template create<sinks::mmap_file_sink_mt>(logger_name, std::move(config));
+}
+
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> mmap_logger_st(const std::string &logger_name, sinks::mmap_file_sink_config config)
+{
+    return Factory::template create<sinks::mmap_file_sink_st>(logger_name, std::move(config));
+}
+
+} // namespace spdlog
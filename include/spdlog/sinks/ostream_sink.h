@@ -28,6 +28,7 @@ protected:
         memory_buf_t formatted;
         base_sink<Mutex>::formatter_->format(msg, formatted);
         ostream_.write(formatted.data(), static_cast<std::streamsize>(formatted.size()));
+        base_sink<Mutex>::metrics_.add_bytes(formatted.size());
         if (force_flush_)
         {
             ostream_.flush();
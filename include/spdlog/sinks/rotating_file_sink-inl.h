@@ -11,31 +11,68 @@
 
 #include <spdlog/details/file_helper.h>
 #include <spdlog/details/null_mutex.h>
+#include <spdlog/details/task_worker.h>
 #include <spdlog/fmt/fmt.h>
+#ifdef SPDLOG_ZLIB
+#    include <spdlog/details/gzip_writer.h>
+#endif
 
+#include <algorithm>
 #include <cerrno>
 #include <chrono>
+#include <cstdio>
 #include <ctime>
 #include <mutex>
 #include <string>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 namespace spdlog {
 namespace sinks {
 
 template<typename Mutex>
 SPDLOG_INLINE rotating_file_sink<Mutex>::rotating_file_sink(
-    filename_t base_filename, std::size_t max_size, std::size_t max_files, bool rotate_on_open)
+    filename_t base_filename, std::size_t max_size, std::size_t max_files, bool rotate_on_open, rotation_mode mode, const file_options &options)
     : base_filename_(std::move(base_filename))
     , max_size_(max_size)
     , max_files_(max_files)
+    , options_(options)
+    , file_helper_(details::make_unique<details::file_helper>(options_))
 {
-    file_helper_.open(calc_filename(base_filename_, 0));
-    current_size_ = file_helper_.size(); // expensive. called only once
+#ifdef SPDLOG_ZLIB
+    compress_ = mode == rotation_mode::compress;
+#endif
+    recover_next_files_();
+    file_helper_->open(calc_filename(base_filename_, 0));
+    current_size_ = file_helper_->size(); // expensive. called only once
     if (rotate_on_open && current_size_ > 0)
     {
         rotate_();
     }
+
+#ifndef _WIN32
+    if (mode != rotation_mode::blocking)
+    {
+        worker_ = details::make_unique<details::task_worker>();
+        worker_->post([this] { prepare_next_file_(); });
+    }
+#else
+    (void)mode;
+#endif
+}
+
+template<typename Mutex>
+SPDLOG_INLINE rotating_file_sink<Mutex>::~rotating_file_sink()
+{
+    // let the worker finish the pending renames, then drop the file it opened in advance
+    worker_.reset();
+    if (next_file_)
+    {
+        auto next_filename = next_file_->filename();
+        next_file_->close();
+        (void)details::os::remove(next_filename);
+    }
 }
 
 // calc filename according to index and file extension if exists.
@@ -56,8 +93,8 @@ SPDLOG_INLINE filename_t rotating_file_sink<Mutex>::calc_filename(const filename
 template<typename Mutex>
 SPDLOG_INLINE filename_t rotating_file_sink<Mutex>::filename()
 {
-    std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
-    return file_helper_.filename();
+    // the current file may have a temporary name while a background rotation completes
+    return calc_filename(base_filename_, 0);
 }
 
 template<typename Mutex>
@@ -71,13 +108,39 @@ SPDLOG_INLINE void rotating_file_sink<Mutex>::sink_it_(const details::log_msg &m
         rotate_();
         current_size_ = formatted.size();
     }
-    file_helper_.write(formatted);
+    file_helper_->write(formatted);
+    base_sink<Mutex>::metrics_.add_bytes(formatted.size());
+}
+
+// as sink_it_(), with the same buffer for every message of the batch.
+// a message counts as logged once written, so that a failed write is retried from the message it failed on.
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::sink_batch_(details::span<const details::log_msg *const> msgs, size_t &logged)
+{
+    memory_buf_t formatted;
+    for (; logged < msgs.size(); ++logged)
+    {
+        formatted.clear();
+        base_sink<Mutex>::formatter_->format(*msgs[logged], formatted);
+        current_size_ += formatted.size();
+        if (current_size_ > max_size_)
+        {
+            rotate_();
+            current_size_ = formatted.size();
+        }
+        file_helper_->write(formatted);
+        base_sink<Mutex>::metrics_.add_bytes(formatted.size());
+    }
 }
 
 template<typename Mutex>
 SPDLOG_INLINE void rotating_file_sink<Mutex>::flush_()
 {
-    file_helper_.flush();
+    file_helper_->flush();
+    if (worker_)
+    {
+        throw_worker_error_();
+    }
 }
 
 // Rotate files:
@@ -88,17 +151,24 @@ SPDLOG_INLINE void rotating_file_sink<Mutex>::flush_()
 template<typename Mutex>
 SPDLOG_INLINE void rotating_file_sink<Mutex>::rotate_()
 {
+    if (worker_)
+    {
+        rotate_background_();
+        return;
+    }
+
     using details::os::filename_to_str;
     using details::os::path_exists;
-    file_helper_.close();
+    compress_rotated_(); // see shift_files_()
+    file_helper_->close();
     for (auto i = max_files_; i > 0; --i)
     {
-        filename_t src = calc_filename(base_filename_, i - 1);
+        filename_t src = rotated_filename_(i - 1);
         if (!path_exists(src))
         {
             continue;
         }
-        filename_t target = calc_filename(base_filename_, i);
+        filename_t target = shifted_filename_(i);
 
         if (!rename_file_(src, target))
         {
@@ -108,13 +178,230 @@ SPDLOG_INLINE void rotating_file_sink<Mutex>::rotate_()
             details::os::sleep_for_millis(100);
             if (!rename_file_(src, target))
             {
-                file_helper_.reopen(true); // truncate the log file anyway to prevent it to grow beyond its limit!
+                file_helper_->reopen(true); // truncate the log file anyway to prevent it to grow beyond its limit!
                 current_size_ = 0;
                 throw_spdlog_ex("rotating_file_sink: failed renaming " + filename_to_str(src) + " to " + filename_to_str(target), errno);
             }
         }
     }
-    file_helper_.reopen(true);
+    file_helper_->reopen(true);
+    compress_rotated_();
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::rotate_background_()
+{
+    std::unique_ptr<details::file_helper> next;
+    size_t seq = 0;
+    {
+        std::lock_guard<std::mutex> lock(next_file_mutex_);
+        next = std::move(next_file_);
+        if (!next)
+        {
+            seq = ++next_seq_;
+        }
+    }
+    if (!next)
+    {
+        // the worker is behind (e.g. still renaming): open the next file here
+        next = open_next_file_(seq);
+    }
+
+    // std::function needs a copyable callable, so the full file is shared with the task
+    std::shared_ptr<details::file_helper> full_file(std::move(file_helper_));
+    file_helper_ = std::move(next);
+    auto new_filename = file_helper_->filename();
+    worker_->post([this, full_file, new_filename] { finish_rotation_(*full_file, new_filename); });
+    worker_->post([this] { prepare_next_file_(); });
+    throw_worker_error_();
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::finish_rotation_(details::file_helper &full_file, const filename_t &new_filename)
+{
+    full_file.close();
+    auto current = calc_filename(base_filename_, 0);
+
+    // the helper keeps the name the file was opened with (log.next1.txt), which is where the file still is
+    // if the rotation that switched to it failed to rename it. it is then newer than log.txt, if any,
+    // and takes its place first.
+    if (full_file.filename() != current && details::os::path_exists(full_file.filename()))
+    {
+        if (details::os::path_exists(current))
+        {
+            shift_files_();
+        }
+        rename_or_throw_(full_file.filename(), current);
+    }
+
+    // log.txt -> log.1.txt ... as in rotate_(), then log.next1.txt -> log.txt
+    shift_files_();
+    rename_or_throw_(new_filename, current);
+    compress_rotated_();
+}
+
+// log.txt -> log.1.txt, log.1.txt -> log.2.txt ... and the last one is deleted, as in rotate_().
+// throws if a rename fails.
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::shift_files_()
+{
+    // when compressing, a log.1.txt left by a failed or interrupted compression would be
+    // overwritten by log.txt: compress it first, or keep it in place if that fails again.
+    compress_rotated_();
+    for (auto i = max_files_; i > 0; --i)
+    {
+        filename_t src = rotated_filename_(i - 1);
+        if (details::os::path_exists(src))
+        {
+            rename_or_throw_(src, shifted_filename_(i));
+        }
+    }
+}
+
+// a crash during a background rotation, or a failed rename, leaves the file it switched to
+// with its temporary name (log.next1.txt). put such files back in the chain, oldest first,
+// and drop the empty ones (files opened in advance and never written).
+// the sequence numbers continue after theirs, so a file of a previous run is never reopened.
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::recover_next_files_()
+{
+    filename_t basename, ext;
+    std::tie(basename, ext) = details::file_helper::split_by_extension(base_filename_);
+    filename_t dir = details::os::dir_name(base_filename_);
+    filename_t prefix = basename.substr(dir.empty() ? 0 : dir.size() + 1) + SPDLOG_FILENAME_T(".next");
+
+    std::vector<std::pair<size_t, filename_t>> found;
+    for (auto &name : details::os::dir_entries(dir.empty() ? filename_t(SPDLOG_FILENAME_T(".")) : dir))
+    {
+        if (name.size() <= prefix.size() + ext.size() || name.compare(0, prefix.size(), prefix) != 0 ||
+            name.compare(name.size() - ext.size(), ext.size(), ext) != 0)
+        {
+            continue;
+        }
+        size_t seq = 0;
+        size_t i = prefix.size();
+        for (; i < name.size() - ext.size() && name[i] >= '0' && name[i] <= '9'; i++)
+        {
+            seq = seq * 10 + static_cast<size_t>(name[i] - '0');
+        }
+        if (i != name.size() - ext.size())
+        {
+            continue;
+        }
+        found.emplace_back(seq, dir.empty() ? name : dir + details::os::folder_seps_filename[0] + name);
+        next_seq_ = (std::max)(next_seq_, seq);
+    }
+    std::sort(found.begin(), found.end());
+
+    auto current = calc_filename(base_filename_, 0);
+    for (auto &file : found)
+    {
+        std::FILE *fd;
+        if (details::os::fopen_s(&fd, file.second, SPDLOG_FILENAME_T("rb")))
+        {
+            continue;
+        }
+        auto size = details::os::filesize(fd);
+        std::fclose(fd);
+        if (size == 0)
+        {
+            (void)details::os::remove(file.second);
+            continue;
+        }
+        if (details::os::path_exists(current))
+        {
+            shift_files_();
+        }
+        rename_or_throw_(file.second, current);
+    }
+    compress_rotated_();
+}
+
+// the name of the file of the given index: log.3.txt, or log.3.txt.gz when compressing.
+template<typename Mutex>
+SPDLOG_INLINE filename_t rotating_file_sink<Mutex>::rotated_filename_(std::size_t index) const
+{
+    auto filename = calc_filename(base_filename_, index);
+    if (compress_ && index > 0)
+    {
+        filename += SPDLOG_FILENAME_T(".gz");
+    }
+    return filename;
+}
+
+// the name the file of index - 1 is renamed to. when compressing, log.txt
+// becomes log.1.txt, which compress_rotated_() then turns into log.1.txt.gz.
+template<typename Mutex>
+SPDLOG_INLINE filename_t rotating_file_sink<Mutex>::shifted_filename_(std::size_t index) const
+{
+    return index == 1 ? calc_filename(base_filename_, 1) : rotated_filename_(index);
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::compress_rotated_()
+{
+#ifdef SPDLOG_ZLIB
+    auto src = calc_filename(base_filename_, 1);
+    if (compress_ && details::os::path_exists(src))
+    {
+        details::gzip_file(src, rotated_filename_(1), SPDLOG_GZIP_MEMBER_SIZE);
+        (void)details::os::remove(src);
+    }
+#endif
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::prepare_next_file_()
+{
+    size_t seq;
+    {
+        std::lock_guard<std::mutex> lock(next_file_mutex_);
+        if (next_file_)
+        {
+            return;
+        }
+        seq = ++next_seq_;
+    }
+    auto next = open_next_file_(seq);
+    std::lock_guard<std::mutex> lock(next_file_mutex_);
+    next_file_ = std::move(next);
+}
+
+template<typename Mutex>
+SPDLOG_INLINE std::unique_ptr<details::file_helper> rotating_file_sink<Mutex>::open_next_file_(size_t seq)
+{
+    filename_t basename, ext;
+    std::tie(basename, ext) = details::file_helper::split_by_extension(base_filename_);
+    auto next = details::make_unique<details::file_helper>(options_);
+    // never truncate: sequence numbers are past the files found at startup, and a file is better appended to than lost
+    next->open(fmt::format(SPDLOG_FILENAME_T("{}.next{}{}"), basename, seq, ext), false);
+    return next;
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::throw_worker_error_()
+{
+    auto error = worker_->take_error();
+    if (!error.empty())
+    {
+        throw_spdlog_ex("rotating_file_sink: background rotation failed: " + error);
+    }
+}
+
+// rename_file_(), retried once after a small delay as in rotate_(), throwing if it fails again.
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::rename_or_throw_(const filename_t &src_filename, const filename_t &target_filename)
+{
+    using details::os::filename_to_str;
+    if (!rename_file_(src_filename, target_filename))
+    {
+        details::os::sleep_for_millis(100);
+        if (!rename_file_(src_filename, target_filename))
+        {
+            throw_spdlog_ex(
+                "rotating_file_sink: failed renaming " + filename_to_str(src_filename) + " to " + filename_to_str(target_filename), errno);
+        }
+    }
 }
 
 // delete the target if exists, and rename the src file  to target
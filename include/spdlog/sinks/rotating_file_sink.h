@@ -7,27 +7,50 @@
 #include <spdlog/details/file_helper.h>
 #include <spdlog/details/null_mutex.h>
 #include <spdlog/details/synchronous_factory.h>
+#include <spdlog/details/task_worker.h>
 
 #include <chrono>
+#include <memory>
 #include <mutex>
 #include <string>
 
 namespace spdlog {
 namespace sinks {
 
+// how rotating_file_sink renames the files once the current one is full
+enum class rotation_mode
+{
+    // rename the files, then reopen the current one, with the sink locked
+    blocking,
+    // switch at once to a file opened in advance, and rename the files in a worker thread.
+    // until the worker renamed it, the new file is named like log.next1.txt. such files left by
+    // a crash or a failed rename are put back in the chain by the next sink opening the log.
+    // on windows, where open files cannot be renamed, this falls back to blocking.
+    background,
+#ifdef SPDLOG_ZLIB
+    // as background, and the worker also gzips the rotated files: log.1.txt.gz, log.2.txt.gz...
+    // (on windows, as blocking and compressing in the logging thread).
+    compress
+#endif
+};
+
 //
-// Rotating file sink based on size
+// Rotating file sink based on size.
+// The file_options select how the files are written (see details::file_helper).
 //
 template<typename Mutex>
 class rotating_file_sink final : public base_sink<Mutex>
 {
 public:
-    rotating_file_sink(filename_t base_filename, std::size_t max_size, std::size_t max_files, bool rotate_on_open = false);
+    rotating_file_sink(filename_t base_filename, std::size_t max_size, std::size_t max_files, bool rotate_on_open = false,
+        rotation_mode mode = rotation_mode::blocking, const file_options &options = {});
+    ~rotating_file_sink() override;
     static filename_t calc_filename(const filename_t &filename, std::size_t index);
     filename_t filename();
 
 protected:
     void sink_it_(const details::log_msg &msg) override;
+    void sink_batch_(details::span<const details::log_msg *const> msgs, size_t &logged) override;
     void flush_() override;
 
 private:
@@ -38,15 +61,45 @@ private:
     // log.3.txt -> delete
     void rotate_();
 
+    // background mode: swap in the next file and post the renames to the worker.
+    void rotate_background_();
+    // the worker's part: close the full file, shift the older ones and give the new file its name.
+    void finish_rotation_(details::file_helper &full_file, const filename_t &new_filename);
+    // log.txt -> log.1.txt ... as rotate_() does, throwing if a rename fails.
+    void shift_files_();
+    // at startup: put the files a crashed or failed background rotation left (log.next1.txt) back in the chain.
+    void recover_next_files_();
+    // the worker opens the file of the next rotation in advance.
+    void prepare_next_file_();
+    // open the file a rotation switches to, named after the given sequence number.
+    std::unique_ptr<details::file_helper> open_next_file_(size_t seq);
+    // throw the error of the last failed background rotation, if any.
+    void throw_worker_error_();
+
+    filename_t rotated_filename_(std::size_t index) const;
+    filename_t shifted_filename_(std::size_t index) const;
+    // compress mode: gzip log.1.txt into log.1.txt.gz
+    void compress_rotated_();
+
     // delete the target if exists, and rename the src file  to target
     // return true on success, false otherwise.
     bool rename_file_(const filename_t &src_filename, const filename_t &target_filename);
+    void rename_or_throw_(const filename_t &src_filename, const filename_t &target_filename);
 
     filename_t base_filename_;
     std::size_t max_size_;
     std::size_t max_files_;
     std::size_t current_size_;
-    details::file_helper file_helper_;
+    file_options options_;
+    std::unique_ptr<details::file_helper> file_helper_;
+    bool compress_{false};
+
+    // background mode: the file opened in advance by the worker (guarded by next_file_mutex_)
+    std::unique_ptr<details::file_helper> next_file_;
+    std::mutex next_file_mutex_;
+    size_t next_seq_{0};
+    // last member, so that it is destroyed (and runs its remaining tasks) first
+    std::unique_ptr<details::task_worker> worker_;
 };
 
 using rotating_file_sink_mt = rotating_file_sink<std::mutex>;
@@ -59,17 +112,21 @@ using rotating_file_sink_st = rotating_file_sink<details::null_mutex>;
 //
 
 template<typename Factory = spdlog::synchronous_factory>
-inline std::shared_ptr<logger> rotating_logger_mt(
-    const std::string &logger_name, const filename_t &filename, size_t max_file_size, size_t max_files, bool rotate_on_open = false)
+inline std::shared_ptr<logger> rotating_logger_mt(const std::string &logger_name, const filename_t &filename, size_t max_file_size,
+    size_t max_files, bool rotate_on_open = false, sinks::rotation_mode mode = sinks::rotation_mode::blocking,
+    const file_options &options = {})
 {
-    return Factory::template create<sinks::rotating_file_sink_mt>(logger_name, filename, max_file_size, max_files, rotate_on_open);
+    return Factory::template create<sinks::rotating_file_sink_mt>(
+        logger_name, filename, max_file_size, max_files, rotate_on_open, mode, options);
 }
 
 template<typename Factory = spdlog::synchronous_factory>
-inline std::shared_ptr<logger> rotating_logger_st(
-    const std::string &logger_name, const filename_t &filename, size_t max_file_size, size_t max_files, bool rotate_on_open = false)
+inline std::shared_ptr<logger> rotating_logger_st(const std::string &logger_name, const filename_t &filename, size_t max_file_size,
+    size_t max_files, bool rotate_on_open = false, sinks::rotation_mode mode = sinks::rotation_mode::blocking,
+    const file_options &options = {})
 {
-    return Factory::template create<sinks::rotating_file_sink_st>(logger_name, filename, max_file_size, max_files, rotate_on_open);
+    return Factory::template create<sinks::rotating_file_sink_st>(
+        logger_name, filename, max_file_size, max_files, rotate_on_open, mode, options);
 }
 } // namespace spdlog
 
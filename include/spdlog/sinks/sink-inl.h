@@ -9,6 +9,14 @@
 
 #include <spdlog/common.h>
 
+SPDLOG_INLINE void spdlog::sinks::sink::log_batch(details::span<const details::log_msg *const> msgs, size_t &logged)
+{
+    for (logged = 0; logged < msgs.size(); ++logged)
+    {
+        log(*msgs[logged]);
+    }
+}
+
 SPDLOG_INLINE bool spdlog::sinks::sink::should_log(spdlog::level::level_enum msg_level) const
 {
     return msg_level >= level_.load(std::memory_order_relaxed);
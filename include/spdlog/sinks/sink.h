@@ -4,6 +4,7 @@
 #pragma once
 
 #include <spdlog/details/log_msg.h>
+#include <spdlog/details/span.h>
 #include <spdlog/formatter.h>
 #include <spdlog/json_formatter.h>
 
@@ -15,6 +16,11 @@ class SPDLOG_API sink
 public:
     virtual ~sink() = default;
     virtual void log(const details::log_msg &msg) = 0;
+    // log a batch of messages, in order (used by the async thread pool).
+    // all the messages pass should_log(). the default implementation calls log() for each.
+    // if it throws, logged is the number of messages logged before the failure; the rest were not,
+    // and the async logger logs them again one by one.
+    virtual void log_batch(details::span<const details::log_msg *const> msgs, size_t &logged);
     virtual void flush() = 0;
     virtual void set_pattern(const std::string &pattern) = 0;
     virtual void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) = 0;
@@ -67,6 +67,7 @@ protected:
             client_.connect(config_.server_host, config_.server_port);
         }
         client_.send(formatted.data(), formatted.size());
+        spdlog::sinks::base_sink<Mutex>::metrics_.add_bytes(formatted.size());
     }
 
     void flush_() override {}
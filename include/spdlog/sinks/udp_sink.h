@@ -51,6 +51,7 @@ protected:
         spdlog::memory_buf_t formatted;
         spdlog::sinks::base_sink<Mutex>::formatter_->format(msg, formatted);
         client_.send(formatted.data(), formatted.size());
+        spdlog::sinks::base_sink<Mutex>::metrics_.add_bytes(formatted.size());
     }
 
     void flush_() override {}    
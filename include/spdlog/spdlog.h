@@ -299,6 +299,13 @@ inline SPDLOG_EXECUTOR_T critical(const T &msg)
 
 #define SPDLOG_LOGGER_CALL(logger, level, ...) (logger)->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, level, __VA_ARGS__)
 
+#ifdef SPDLOG_JSON_LOGGER
+// extra params that are only built if the entry is going to be logged:
+// SPDLOG_DEBUG("request")(SPDLOG_LAZY_PARAMS({{"user_id", id}, {"path", path}}));
+#    define SPDLOG_LAZY_PARAMS(...)                                                                                                        \
+        [&]() -> nlohmann::json { return __VA_ARGS__; }
+#endif
+
 #if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
 #    define SPDLOG_LOGGER_TRACE(logger, ...) SPDLOG_LOGGER_CALL(logger, spdlog::level::trace, __VA_ARGS__)
 #    define SPDLOG_TRACE(...) SPDLOG_LOGGER_TRACE(spdlog::default_logger_raw(), __VA_ARGS__)
@@ -123,6 +123,13 @@
 // #define SPDLOG_FUNCTION __PRETTY_FUNCTION__
 ///////////////////////////////////////////////////////////////////////////////
 
+///////////////////////////////////////////////////////////////////////////////
+// Uncomment (and change if desired) to set the max number of messages an async
+// worker thread dequeues and passes to the sinks at once (default is 64).
+//
+// #define SPDLOG_ASYNC_BATCH_SIZE 64
+///////////////////////////////////////////////////////////////////////////////
+
 ///////////////////////////////////////////////////////////////////////////////
 // Uncomment to enable json formatter.
 //
@@ -7,6 +7,7 @@
 
 #include <spdlog/details/null_mutex.h>
 #include <spdlog/details/file_helper-inl.h>
+#include <spdlog/details/task_worker-inl.h>
 #include <spdlog/sinks/basic_file_sink-inl.h>
 #include <spdlog/sinks/base_sink-inl.h>
 
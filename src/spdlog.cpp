@@ -18,8 +18,12 @@
 #include <spdlog/sinks/base_sink-inl.h>
 #include <spdlog/details/null_mutex.h>
 #include <spdlog/details/executor-inl.h>
+#include <spdlog/details/timestamp_renderer-inl.h>
+#include <spdlog/json_writer-inl.h>
+#include <spdlog/field_key-inl.h>
 #include <spdlog/populators-inl.h>
 #include <spdlog/json_formatter-inl.h>
+#include <spdlog/binary_formatter-inl.h>
 
 #include <mutex>
 
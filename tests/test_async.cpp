@@ -189,3 +189,345 @@ TEST_CASE("to_file multi-workers", "[async]")
 
     require_message_count(TEST_FILENAME, messages);
 }
+
+TEST_CASE("lockfree queue multi threads", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    size_t queue_size = 16;
+    size_t messages = 1024;
+    size_t n_threads = 8;
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(queue_size, 2, spdlog::async_queue_type::lockfree);
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < n_threads; i++)
+        {
+            threads.emplace_back([logger, messages] {
+                for (size_t j = 0; j < messages; j++)
+                {
+                    logger->info("Hello message #{}", j);
+                }
+            });
+        }
+
+        for (auto &t : threads)
+        {
+            t.join();
+        }
+        logger->flush();
+        REQUIRE(tp->overrun_counter() == 0);
+    }
+
+    REQUIRE(test_sink->msg_counter() == messages * n_threads);
+    REQUIRE(test_sink->flush_counter() == 1);
+}
+
+TEST_CASE("lockfree queue discard policy", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_delay(std::chrono::milliseconds(1));
+    size_t queue_size = 4;
+    size_t messages = 1024;
+
+    auto tp = std::make_shared<spdlog::details::thread_pool>(queue_size, 1, spdlog::async_queue_type::lockfree);
+    auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::overrun_oldest);
+    for (size_t i = 0; i < messages; i++)
+    {
+        logger->info("Hello message");
+    }
+    REQUIRE(test_sink->msg_counter() < messages);
+    REQUIRE(tp->overrun_counter() > 0);
+    REQUIRE(tp->queue_size() <= queue_size);
+}
+
+TEST_CASE("lockfree queue keeps fifo order", "[async]")
+{
+    spdlog::details::mpmc_lockfree_queue<int> q(3);
+    for (int i = 0; i < 5; i++)
+    {
+        int item = i;
+        q.enqueue_nowait(std::move(item));
+    }
+    REQUIRE(q.overrun_counter() == 2);
+    REQUIRE(q.size() == 3);
+
+    int popped = -1;
+    for (int expected : {2, 3, 4})
+    {
+        REQUIRE(q.dequeue_for(popped, std::chrono::milliseconds(0)));
+        REQUIRE(popped == expected);
+    }
+    REQUIRE_FALSE(q.dequeue_for(popped, std::chrono::milliseconds(1)));
+    REQUIRE(q.size() == 0);
+}
+
+namespace {
+class batch_sink : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+    size_t msg_counter = 0;
+    size_t batch_counter = 0;
+    size_t max_batch = 0;
+    size_t filtered_out_counter = 0;
+
+protected:
+    void sink_it_(const spdlog::details::log_msg &) override
+    {
+        msg_counter++;
+        batch_counter++;
+        max_batch = std::max<size_t>(max_batch, 1);
+    }
+
+    void sink_batch_(spdlog::details::span<const spdlog::details::log_msg *const> msgs, size_t &logged) override
+    {
+        // give the producer a chance to fill the queue
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        for (auto *msg : msgs)
+        {
+            filtered_out_counter += msg->level < level() ? 1 : 0;
+        }
+        msg_counter += msgs.size();
+        logged = msgs.size();
+        batch_counter++;
+        max_batch = std::max(max_batch, msgs.size());
+    }
+
+    void flush_() override {}
+};
+} // namespace
+
+TEST_CASE("batched sink writes", "[async]")
+{
+    auto sink = std::make_shared<batch_sink>();
+    auto warn_sink = std::make_shared<batch_sink>();
+    warn_sink->set_level(spdlog::level::warn);
+    size_t messages = 512;
+    for (auto queue_type : {spdlog::async_queue_type::blocking, spdlog::async_queue_type::lockfree})
+    {
+        {
+            auto tp = std::make_shared<spdlog::details::thread_pool>(messages, 1, queue_type);
+            auto logger = std::make_shared<spdlog::async_logger>(
+                "as", spdlog::sinks_init_list{sink, warn_sink}, tp, spdlog::async_overflow_policy::block);
+            for (size_t i = 0; i < messages; i++)
+            {
+                logger->log(i % 2 ? spdlog::level::warn : spdlog::level::info, "Hello message #{}", i);
+            }
+        }
+        REQUIRE(sink->msg_counter == messages);
+        REQUIRE(warn_sink->msg_counter == messages / 2);
+        REQUIRE(warn_sink->filtered_out_counter == 0);
+        REQUIRE(sink->batch_counter < messages);
+        REQUIRE(sink->max_batch <= SPDLOG_ASYNC_BATCH_SIZE);
+        sink->msg_counter = warn_sink->msg_counter = 0;
+    }
+}
+
+TEST_CASE("batched rotating file sink", "[async]")
+{
+    prepare_logdir();
+    size_t messages = 1000;
+    spdlog::filename_t basename = SPDLOG_FILENAME_T("test_logs/async_rotating_log");
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(messages, 1);
+        auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(basename, 10 * 1024, 1);
+        sink->set_pattern("%v");
+        auto logger = std::make_shared<spdlog::async_logger>("as", sink, tp, spdlog::async_overflow_policy::block);
+        for (size_t i = 0; i < messages; i++)
+        {
+            logger->info("Hello message #{:04}", i);
+        }
+    }
+
+    // the current file holds the last lines, the rotated one the previous 10KB
+    size_t line_size = strlen("Hello message #0000") + strlen(spdlog::details::os::default_eol);
+    auto current = file_contents("test_logs/async_rotating_log");
+    auto rotated = file_contents("test_logs/async_rotating_log.1");
+    REQUIRE(current.size() <= 10 * 1024);
+    REQUIRE(rotated.size() <= 10 * 1024);
+    REQUIRE(ends_with(current, fmt::format("Hello message #0999{}", spdlog::details::os::default_eol)));
+    REQUIRE(current.size() % line_size == 0);
+    REQUIRE(rotated.size() % line_size == 0);
+    REQUIRE(current.size() + rotated.size() >= 10 * 1024);
+}
+
+namespace {
+// records the payloads it gets, and whether two workers ever wrote to it at once.
+class order_sink : public spdlog::sinks::base_sink<spdlog::details::null_mutex>
+{
+public:
+    std::vector<int> received;
+    std::atomic<int> writers{0};
+    std::atomic<bool> overlapped{false};
+    size_t flush_counter = 0;
+
+protected:
+    void sink_it_(const spdlog::details::log_msg &msg) override
+    {
+        if (writers.fetch_add(1) != 0)
+        {
+            overlapped = true;
+        }
+        received.push_back(std::stoi(std::string(msg.payload.data(), msg.payload.size())));
+        writers.fetch_sub(1);
+    }
+
+    void flush_() override
+    {
+        flush_counter++;
+    }
+};
+} // namespace
+
+TEST_CASE("sharded pool keeps the order of each logger", "[async]")
+{
+    const int messages = 2000;
+    const size_t loggers_n = 8;
+    for (auto queue_type : {spdlog::async_queue_type::blocking, spdlog::async_queue_type::lockfree})
+    {
+        std::vector<std::shared_ptr<order_sink>> sinks;
+        size_t overrun_counter = 0;
+        {
+            auto tp = std::make_shared<spdlog::details::thread_pool>(1024, 4, queue_type, spdlog::async_pool_mode::sharded);
+            std::vector<std::thread> producers;
+            for (size_t i = 0; i < loggers_n; i++)
+            {
+                sinks.push_back(std::make_shared<order_sink>());
+                auto logger = std::make_shared<spdlog::async_logger>("as", sinks.back(), tp, spdlog::async_overflow_policy::block);
+                producers.emplace_back([logger, messages] {
+                    for (int n = 0; n < messages; n++)
+                    {
+                        logger->info("{}", n);
+                    }
+                    logger->flush();
+                });
+            }
+            for (auto &t : producers)
+            {
+                t.join();
+            }
+            overrun_counter = tp->overrun_counter();
+        }
+
+        REQUIRE(overrun_counter == 0);
+        for (auto &sink : sinks)
+        {
+            REQUIRE(sink->received.size() == static_cast<size_t>(messages));
+            REQUIRE(std::is_sorted(sink->received.begin(), sink->received.end()));
+            REQUIRE_FALSE(sink->overlapped);
+            REQUIRE(sink->flush_counter == 1);
+        }
+    }
+}
+
+TEST_CASE("thread pool wait strategies", "[async]")
+{
+    using spdlog::async_wait_strategy;
+    size_t messages = 1000;
+    for (auto strategy : {async_wait_strategy::block, async_wait_strategy::spin_yield, async_wait_strategy::busy_spin})
+    {
+        for (auto pool_mode : {spdlog::async_pool_mode::shared, spdlog::async_pool_mode::sharded})
+        {
+            auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+            {
+                auto tp = std::make_shared<spdlog::details::thread_pool>(64, 2, spdlog::async_queue_type::blocking, pool_mode, strategy);
+                auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+                for (size_t i = 0; i < messages; i++)
+                {
+                    logger->info("Hello message #{}", i);
+                }
+                logger->flush();
+            }
+            REQUIRE(test_sink->msg_counter() == messages);
+            REQUIRE(test_sink->flush_counter() == 1);
+        }
+    }
+}
+
+namespace {
+// counts the messages of each level, and keeps the warnings.
+class level_count_sink : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+    size_t counts[spdlog::level::n_levels] = {};
+    std::vector<std::string> warnings;
+
+protected:
+    void sink_it_(const spdlog::details::log_msg &msg) override
+    {
+        // let the queue fill up
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        counts[msg.level]++;
+        if (msg.level == spdlog::level::warn)
+        {
+            warnings.emplace_back(msg.payload.data(), msg.payload.size());
+        }
+    }
+
+    void flush_() override {}
+};
+} // namespace
+
+TEST_CASE("drop by level overflow policy", "[async]")
+{
+    auto sink = std::make_shared<level_count_sink>();
+    size_t messages = 1000;
+    size_t dropped_debug = 0;
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(64, 1);
+        auto logger = std::make_shared<spdlog::async_logger>("as", sink, tp, spdlog::async_overflow_policy::drop_by_level);
+        logger->set_level(spdlog::level::trace);
+        for (size_t i = 0; i < messages; i++)
+        {
+            logger->log(i % 2 ? spdlog::level::err : spdlog::level::debug, "Hello message #{}", i);
+        }
+        logger->flush();
+        dropped_debug = logger->dropped_count(spdlog::level::debug);
+        REQUIRE(logger->dropped_count(spdlog::level::err) == 0);
+    }
+
+    // debug messages gave way to errors, which were all kept
+    REQUIRE(sink->counts[spdlog::level::err] == messages / 2);
+    REQUIRE(dropped_debug > 0);
+    REQUIRE(sink->counts[spdlog::level::debug] + dropped_debug == messages / 2);
+
+    // the drops were reported, the last ones by the flush
+    REQUIRE_FALSE(sink->warnings.empty());
+    size_t reported = 0;
+    for (auto &warning : sink->warnings)
+    {
+        REQUIRE(warning.find("async queue overflow: dropped ") == 0);
+        reported += std::stoul(warning.substr(strlen("async queue overflow: dropped ")));
+    }
+    REQUIRE(reported == dropped_debug);
+    REQUIRE(ends_with(sink->warnings.back(), " debug)"));
+}
+
+TEST_CASE("thread pool metrics", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    size_t messages = 256;
+    auto tp = std::make_shared<spdlog::details::thread_pool>(128, 1);
+    auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+    for (size_t i = 0; i < messages; i++)
+    {
+        logger->info("Hello message #{}", i);
+    }
+    logger->flush();
+    // the latencies are recorded once the whole batch went through the sinks
+    while (test_sink->flush_counter() == 0 || tp->sink_latency().count() < messages)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // the log messages and the flush went through the queue
+    auto metrics = tp->metrics();
+    REQUIRE(metrics.dequeued == messages + 1);
+    REQUIRE(metrics.enqueued == messages + 1);
+    REQUIRE(metrics.queue_size == 0);
+    REQUIRE(metrics.max_queue_size >= 1);
+    REQUIRE(metrics.max_queue_size <= 128);
+    REQUIRE(metrics.dropped_overrun == 0);
+    REQUIRE(metrics.dropped_by_level == 0);
+    REQUIRE(tp->sink_latency().count() == messages);
+}
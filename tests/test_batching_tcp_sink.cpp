@@ -0,0 +1,205 @@
+/*
+ * This content is released under the MIT License as specified in https://raw.githubusercontent.com/gabime/spdlog/master/LICENSE
+ */
+#include "includes.h"
+#include "spdlog/sinks/batching_tcp_sink.h"
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+// a collector listening on the loopback interface, which stores what it receives
+class loopback_collector
+{
+public:
+    // port 0 picks a free port
+    explicit loopback_collector(int port = 0)
+    {
+        listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        REQUIRE(listen_fd_ != -1);
+        int enable = 1;
+        ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        REQUIRE(::bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0);
+        REQUIRE(::listen(listen_fd_, 4) == 0);
+        socklen_t len = sizeof(addr);
+        ::getsockname(listen_fd_, reinterpret_cast<sockaddr *>(&addr), &len);
+        port_ = ntohs(addr.sin_port);
+        thread_ = std::thread([this] { loop_(); });
+    }
+
+    ~loopback_collector()
+    {
+        stop_ = true;
+        thread_.join();
+        ::close(listen_fd_);
+    }
+
+    int port() const
+    {
+        return port_;
+    }
+
+    std::string data()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return data_;
+    }
+
+    // wait until the given number of lines were received
+    bool wait_lines(size_t lines, std::chrono::milliseconds timeout = std::chrono::seconds(10))
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            auto received = data();
+            if (static_cast<size_t>(std::count(received.begin(), received.end(), '\n')) >= lines)
+            {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return false;
+    }
+
+private:
+    int listen_fd_ = -1;
+    int port_ = 0;
+    std::atomic<bool> stop_{false};
+    std::mutex mutex_;
+    std::string data_;
+    std::thread thread_;
+
+    // serve one connection at a time, polling so that stop_ is noticed
+    void loop_()
+    {
+        int conn = -1;
+        while (!stop_)
+        {
+            pollfd fd{conn == -1 ? listen_fd_ : conn, POLLIN, 0};
+            if (::poll(&fd, 1, 10) <= 0)
+            {
+                continue;
+            }
+            if (conn == -1)
+            {
+                conn = ::accept(listen_fd_, nullptr, nullptr);
+                continue;
+            }
+            char buf[4096];
+            auto n = ::recv(conn, buf, sizeof(buf), 0);
+            if (n <= 0)
+            {
+                ::close(conn);
+                conn = -1;
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            data_.append(buf, static_cast<size_t>(n));
+        }
+        if (conn != -1)
+        {
+            ::close(conn);
+        }
+    }
+};
+
+// a port nothing listens on
+static int unused_port()
+{
+    loopback_collector collector;
+    return collector.port();
+}
+
+static std::vector<std::string> split_lines(const std::string &data)
+{
+    std::vector<std::string> lines;
+    size_t start = 0;
+    for (size_t pos = data.find('\n'); pos != std::string::npos; pos = data.find('\n', start))
+    {
+        lines.push_back(data.substr(start, pos - start));
+        start = pos + 1;
+    }
+    return lines;
+}
+
+TEST_CASE("batching_tcp_sink ndjson", "[batching_tcp_sink]")
+{
+    loopback_collector collector;
+    spdlog::sinks::batching_tcp_sink_config config("127.0.0.1", collector.port());
+    config.batch_size = 1024;
+    {
+        auto sink = std::make_shared<spdlog::sinks::batching_tcp_sink_mt>(config);
+        spdlog::logger logger("tcp", sink);
+        for (int i = 0; i < 100; i++)
+        {
+            logger.info("Test message {}", i);
+        }
+    }
+
+    // the sink sent everything before closing, one json record per line
+    REQUIRE(collector.wait_lines(100));
+    auto lines = split_lines(collector.data());
+    REQUIRE(lines.size() == 100);
+    for (int i = 0; i < 100; i++)
+    {
+        auto &line = lines[static_cast<size_t>(i)];
+        REQUIRE(line.front() == '{');
+        REQUIRE(line.back() == '}');
+        REQUIRE(line.find(fmt::format("\"message\":\"Test message {}\"", i)) != std::string::npos);
+    }
+}
+
+TEST_CASE("batching_tcp_sink batch interval", "[batching_tcp_sink]")
+{
+    loopback_collector collector;
+    spdlog::sinks::batching_tcp_sink_config config("127.0.0.1", collector.port());
+    config.batch_interval = std::chrono::milliseconds(20);
+    auto sink = std::make_shared<spdlog::sinks::batching_tcp_sink_st>(config);
+    sink->set_pattern("%v");
+
+    // far below batch_size: sent once the message is batch_interval old, without a flush
+    sink->log(spdlog::details::log_msg("test", spdlog::level::info, "one"));
+    REQUIRE(collector.wait_lines(1));
+    sink->log(spdlog::details::log_msg("test", spdlog::level::info, "two"));
+    REQUIRE(collector.wait_lines(2));
+    REQUIRE(collector.data() == "one\ntwo\n");
+    REQUIRE(sink->connects() == 1);
+}
+
+TEST_CASE("batching_tcp_sink collector down", "[batching_tcp_sink]")
+{
+    int port = unused_port();
+    spdlog::sinks::batching_tcp_sink_config config("127.0.0.1", port);
+    config.max_buffer_size = 1000;
+    config.reconnect_min_delay = std::chrono::milliseconds(5);
+    config.reconnect_max_delay = std::chrono::milliseconds(20);
+    auto sink = std::make_shared<spdlog::sinks::batching_tcp_sink_st>(config);
+    sink->set_pattern("%v");
+
+    // logging does not block, and what does not fit in the buffer is dropped
+    std::string expected;
+    for (int i = 0; i < 100; i++)
+    {
+        auto msg = fmt::format("Test message {}", i);
+        sink->log(spdlog::details::log_msg("test", spdlog::level::info, msg));
+        if (expected.size() + msg.size() + 1 <= config.max_buffer_size)
+        {
+            expected += msg + '\n';
+        }
+    }
+    REQUIRE_FALSE(sink->is_connected());
+    auto kept = static_cast<size_t>(std::count(expected.begin(), expected.end(), '\n'));
+    REQUIRE(sink->dropped_messages() == 100 - kept);
+    REQUIRE(sink->dropped_bytes() == 100 * 15 + 90 - expected.size());
+
+    // once the collector is up, the sink reconnects and sends what it kept
+    loopback_collector collector(port);
+    REQUIRE(collector.wait_lines(kept));
+    REQUIRE(collector.data() == expected);
+    REQUIRE(sink->connects() == 1);
+}
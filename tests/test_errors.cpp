@@ -5,6 +5,11 @@
 
 #include <iostream>
 
+#ifndef _WIN32
+#    include <csignal>
+#    include <sys/resource.h>
+#endif
+
 #define SIMPLE_LOG "test_logs/simple_log.txt"
 #define SIMPLE_ASYNC_LOG "test_logs/simple_async_log.txt"
 
@@ -119,3 +124,115 @@ TEST_CASE("async_error_handler2", "[errors]]")
     spdlog::init_thread_pool(128, 1);
     REQUIRE(file_contents("test_logs/custom_err2.txt") == err_msg);
 }
+
+namespace {
+// fails on the messages "bad". the first message is slow, so that the next ones are dequeued as one batch.
+class failing_message_sink : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+    std::vector<std::string> received;
+
+protected:
+    void sink_it_(const spdlog::details::log_msg &msg) final
+    {
+        std::string payload(msg.payload.data(), msg.payload.size());
+        if (payload == "bad")
+        {
+            throw std::runtime_error("bad message");
+        }
+        if (received.empty())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        received.push_back(payload);
+    }
+
+    void flush_() final {}
+};
+
+class failing_message_formatter : public spdlog::formatter
+{
+public:
+    void format(const spdlog::details::log_msg &msg, spdlog::memory_buf_t &dest) override
+    {
+        if (msg.payload == spdlog::string_view_t("bad"))
+        {
+            throw std::runtime_error("bad message");
+        }
+        pattern_.format(msg, dest);
+    }
+
+    std::unique_ptr<spdlog::formatter> clone() const override
+    {
+        return spdlog::details::make_unique<failing_message_formatter>();
+    }
+
+private:
+    spdlog::pattern_formatter pattern_{"%v"};
+};
+} // namespace
+
+TEST_CASE("async_error_in_batch", "[errors]]")
+{
+    prepare_logdir();
+    auto sink = std::make_shared<failing_message_sink>();
+    auto file_sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(SPDLOG_FILENAME_T(SIMPLE_ASYNC_LOG), true);
+    file_sink->set_formatter(spdlog::details::make_unique<failing_message_formatter>());
+    std::vector<std::string> errors;
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(128, 1);
+        auto logger = std::make_shared<spdlog::async_logger>("batch", spdlog::sinks_init_list{sink, file_sink}, tp);
+        logger->set_error_handler([&errors](const std::string &msg) { errors.push_back(msg); });
+        // the line of each message is its index
+        for (int i = 0; i < 10; i++)
+        {
+            logger->log(spdlog::source_loc{"batch.cpp", i, "func"}, spdlog::level::info, i == 5 ? "bad" : "good");
+        }
+    }
+
+    // only the failing message is missing, and the errors point at it
+    std::vector<std::string> expected(9, "good");
+    REQUIRE(sink->received == expected);
+    file_sink->flush();
+    require_message_count(SIMPLE_ASYNC_LOG, 9);
+    REQUIRE(errors == std::vector<std::string>(2, "bad message [batch.cpp(5)]"));
+}
+
+#ifndef _WIN32
+TEST_CASE("file sink batch with a failed write", "[errors]]")
+{
+    prepare_logdir();
+    spdlog::file_options options;
+    options.backend = spdlog::file_backend::fd;
+    options.buffer_size = 0;
+    spdlog::sinks::basic_file_sink_st sink(SPDLOG_FILENAME_T(SIMPLE_LOG), true, options);
+    sink.set_pattern("%v");
+    std::vector<spdlog::details::log_msg> msgs;
+    for (int i = 0; i < 3; i++)
+    {
+        msgs.emplace_back("test", spdlog::level::info, i == 0 ? "message 0" : "message n");
+    }
+    std::vector<const spdlog::details::log_msg *> batch;
+    for (auto &msg : msgs)
+    {
+        batch.push_back(&msg);
+    }
+
+    // the file size limit lets only the first message through
+    auto first_size = std::string("message 0").size() + std::string(spdlog::details::os::default_eol).size();
+    struct rlimit limit;
+    REQUIRE(::getrlimit(RLIMIT_FSIZE, &limit) == 0);
+    auto old_limit = limit;
+    auto old_handler = ::signal(SIGXFSZ, SIG_IGN);
+    limit.rlim_cur = first_size;
+    REQUIRE(::setrlimit(RLIMIT_FSIZE, &limit) == 0);
+    size_t logged = 0;
+    REQUIRE_THROWS_AS(sink.log_batch({batch.data(), batch.size()}, logged), spdlog::spdlog_ex);
+    REQUIRE(::setrlimit(RLIMIT_FSIZE, &old_limit) == 0);
+    ::signal(SIGXFSZ, old_handler);
+
+    // so only the messages after it are retried
+    REQUIRE(logged == 1);
+    REQUIRE(get_filesize(SIMPLE_LOG) == first_size);
+}
+#endif
@@ -3,6 +3,11 @@
  */
 #include "includes.h"
 
+#ifndef _WIN32
+#    include <csignal>
+#    include <sys/resource.h>
+#endif
+
 #define TEST_FILENAME "test_logs/file_helper_test.txt"
 
 using spdlog::details::file_helper;
@@ -99,3 +104,120 @@ TEST_CASE("file_helper_split_by_extension", "[file_helper::split_by_extension()]
     test_split_ext(SPDLOG_FILENAME_T("."), SPDLOG_FILENAME_T("."), SPDLOG_FILENAME_T(""));
     test_split_ext(SPDLOG_FILENAME_T("..txt"), SPDLOG_FILENAME_T("."), SPDLOG_FILENAME_T(".txt"));
 }
+
+#ifndef _WIN32
+static void write_message(file_helper &helper, const std::string &msg)
+{
+    spdlog::memory_buf_t buf;
+    buf.append(msg.data(), msg.data() + msg.size());
+    helper.write(buf);
+}
+
+TEST_CASE("file_helper_fd_backend", "[file_helper::write()]]")
+{
+    prepare_logdir();
+    spdlog::filename_t target_filename = SPDLOG_FILENAME_T(TEST_FILENAME);
+    spdlog::file_options options;
+    options.backend = spdlog::file_backend::fd;
+    options.buffer_size = 100;
+    {
+        file_helper helper(options);
+        helper.open(target_filename);
+
+        // the data stays in the buffer until it is full or flushed
+        write_message(helper, std::string(40, 'a'));
+        REQUIRE(helper.size() == 40);
+        REQUIRE(get_filesize(TEST_FILENAME) == 0);
+
+        // then the buffer and the new data are written together
+        write_message(helper, std::string(80, 'b'));
+        REQUIRE(get_filesize(TEST_FILENAME) == 120);
+
+        write_message(helper, std::string(10, 'c'));
+        helper.flush();
+        REQUIRE(get_filesize(TEST_FILENAME) == 130);
+
+        write_message(helper, std::string(5, 'd'));
+        helper.reopen(false);
+        REQUIRE(helper.size() == 135);
+        write_message(helper, std::string(5, 'e'));
+    }
+    REQUIRE(file_contents(TEST_FILENAME) == std::string(40, 'a') + std::string(80, 'b') + std::string(10, 'c') + "dddddeeeee");
+}
+
+TEST_CASE("file_helper_io_uring_backend", "[file_helper::write()]]")
+{
+    prepare_logdir();
+    spdlog::filename_t target_filename = SPDLOG_FILENAME_T(TEST_FILENAME);
+    spdlog::file_options options;
+    // falls back to the fd backend where io_uring is not available
+    options.backend = spdlog::file_backend::io_uring;
+    options.buffer_size = 256;
+    std::string expected;
+    {
+        file_helper helper(options);
+        helper.open(target_filename, true);
+        for (int i = 0; i < 1000; i++)
+        {
+            auto msg = fmt::format("message {} {}\n", i, std::string(static_cast<size_t>(i % 300), 'x'));
+            write_message(helper, msg);
+            expected += msg;
+        }
+        REQUIRE(helper.size() == expected.size());
+        helper.flush();
+        REQUIRE(get_filesize(TEST_FILENAME) == expected.size());
+        write_message(helper, "last\n");
+        expected += "last\n";
+    }
+    REQUIRE(file_contents(TEST_FILENAME) == expected);
+}
+
+TEST_CASE("file_helper_fd_backend partial write", "[file_helper::write()]]")
+{
+    prepare_logdir();
+    spdlog::filename_t target_filename = SPDLOG_FILENAME_T(TEST_FILENAME);
+    spdlog::file_options options;
+    options.backend = spdlog::file_backend::fd;
+    options.buffer_size = 100;
+    file_helper helper(options);
+    helper.open(target_filename);
+    write_message(helper, std::string(80, 'a'));
+
+    // the file size limit stops the write after 50 bytes of the buffer
+    struct rlimit limit;
+    REQUIRE(::getrlimit(RLIMIT_FSIZE, &limit) == 0);
+    auto old_limit = limit;
+    auto old_handler = ::signal(SIGXFSZ, SIG_IGN);
+    limit.rlim_cur = 50;
+    REQUIRE(::setrlimit(RLIMIT_FSIZE, &limit) == 0);
+    REQUIRE_THROWS_AS(write_message(helper, std::string(80, 'b')), spdlog::spdlog_ex);
+    REQUIRE(::setrlimit(RLIMIT_FSIZE, &old_limit) == 0);
+    ::signal(SIGXFSZ, old_handler);
+
+    // the rest of the buffer is written once, and the failed message is dropped
+    helper.flush();
+    REQUIRE(file_contents(TEST_FILENAME) == std::string(80, 'a'));
+}
+#endif
+
+TEST_CASE("file_helper_sync", "[file_helper::flush()]]")
+{
+    prepare_logdir();
+    spdlog::filename_t target_filename = SPDLOG_FILENAME_T(TEST_FILENAME);
+    for (auto backend : {spdlog::file_backend::stdio, spdlog::file_backend::fd})
+    {
+        for (auto sync : {spdlog::file_sync::on_flush, spdlog::file_sync::interval})
+        {
+            spdlog::file_options options;
+            options.backend = backend;
+            options.buffer_size = 16;
+            options.sync = sync;
+            options.sync_interval = std::chrono::milliseconds(0);
+            file_helper helper(options);
+            helper.open(target_filename, true);
+            write_with_helper(helper, 10);
+            write_with_helper(helper, 20);
+            REQUIRE(get_filesize(TEST_FILENAME) == 30);
+        }
+    }
+}
@@ -3,6 +3,8 @@
  */
 #include "includes.h"
 
+#include <thread>
+
 #define SIMPLE_LOG "test_logs/simple_log"
 #define ROTATING_LOG "test_logs/rotating_log"
 
@@ -98,3 +100,125 @@ TEST_CASE("rotating_file_logger2", "[rotating_logger]]")
     REQUIRE(get_filesize(ROTATING_LOG) <= max_size);
     REQUIRE(get_filesize(ROTATING_LOG ".1") <= max_size);
 }
+
+TEST_CASE("rotating_file_logger background rotation", "[rotating_logger]]")
+{
+    prepare_logdir();
+    size_t max_size = 1024;
+    size_t max_files = 20;
+    spdlog::filename_t basename = SPDLOG_FILENAME_T(ROTATING_LOG);
+    {
+        auto logger = spdlog::rotating_logger_mt("logger", basename, max_size, max_files, false, spdlog::sinks::rotation_mode::background);
+        logger->set_pattern("%v");
+        for (int i = 0; i < 200; ++i)
+        {
+            logger->info("Test message {}", i);
+        }
+        spdlog::drop(logger->name());
+    }
+
+    // once the worker is done, the files are where the blocking mode puts them,
+    // and hold every message in order
+    std::string contents;
+    size_t files = 1;
+    for (; files <= max_files; files++)
+    {
+        auto filename = spdlog::sinks::rotating_file_sink_st::calc_filename(ROTATING_LOG, files);
+        if (!spdlog::details::os::path_exists(filename))
+        {
+            break;
+        }
+        REQUIRE(get_filesize(filename) <= max_size);
+    }
+    REQUIRE(files > 2);
+    REQUIRE(count_files("test_logs") == files);
+    for (size_t i = files - 1; i > 0; i--)
+    {
+        contents += file_contents(spdlog::sinks::rotating_file_sink_st::calc_filename(ROTATING_LOG, i));
+    }
+    contents += file_contents(ROTATING_LOG);
+
+    std::string expected;
+    for (int i = 0; i < 200; ++i)
+    {
+        expected += fmt::format("Test message {}{}", i, spdlog::details::os::default_eol);
+    }
+    REQUIRE(contents == expected);
+}
+
+TEST_CASE("rotating_file_logger background rotation with pauses", "[rotating_logger]]")
+{
+    prepare_logdir();
+    size_t max_size = 100;
+    size_t max_files = 20;
+    spdlog::filename_t basename = SPDLOG_FILENAME_T(ROTATING_LOG);
+    size_t errors = 0;
+    {
+        auto logger = spdlog::rotating_logger_mt("logger", basename, max_size, max_files, false, spdlog::sinks::rotation_mode::background);
+        logger->set_pattern("%v");
+        logger->set_error_handler([&errors](const std::string &) { errors++; });
+        for (int i = 0; i < 60; ++i)
+        {
+            logger->info("Test message {}", i);
+            // let the worker finish each rotation before the next one
+            if (i % 5 == 4)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+        }
+        logger->flush();
+        spdlog::drop(logger->name());
+    }
+    REQUIRE(errors == 0);
+
+    // every file holds data, no temporary file is left, and the messages are in order
+    std::string contents;
+    size_t files = 1;
+    for (; files <= max_files; files++)
+    {
+        auto filename = spdlog::sinks::rotating_file_sink_st::calc_filename(ROTATING_LOG, files);
+        if (!spdlog::details::os::path_exists(filename))
+        {
+            break;
+        }
+        REQUIRE(get_filesize(filename) > 0);
+    }
+    REQUIRE(files > 5);
+    REQUIRE(get_filesize(ROTATING_LOG) > 0);
+    REQUIRE(count_files("test_logs") == files);
+    for (size_t i = files - 1; i > 0; i--)
+    {
+        contents += file_contents(spdlog::sinks::rotating_file_sink_st::calc_filename(ROTATING_LOG, i));
+    }
+    contents += file_contents(ROTATING_LOG);
+
+    std::string expected;
+    for (int i = 0; i < 60; ++i)
+    {
+        expected += fmt::format("Test message {}{}", i, spdlog::details::os::default_eol);
+    }
+    REQUIRE(contents == expected);
+}
+
+TEST_CASE("rotating_file_logger recovers the files of a crashed rotation", "[rotating_logger]]")
+{
+    prepare_logdir();
+    // a crash after a background rotation switched files, and before the worker renamed them:
+    // the full file, the file switched to, and the one opened in advance for the next rotation
+    spdlog::details::os::create_dir(SPDLOG_FILENAME_T("test_logs"));
+    {
+        std::ofstream(ROTATING_LOG) << "old\n";
+        std::ofstream(ROTATING_LOG ".next1") << "new\n";
+        std::ofstream{ROTATING_LOG ".next2"};
+    }
+    {
+        auto logger = spdlog::rotating_logger_mt(
+            "logger", SPDLOG_FILENAME_T(ROTATING_LOG), 1024, 3, false, spdlog::sinks::rotation_mode::background);
+        logger->set_pattern("%v");
+        logger->info("Test message");
+        spdlog::drop(logger->name());
+    }
+    REQUIRE(file_contents(ROTATING_LOG ".1") == "old\n");
+    REQUIRE(file_contents(ROTATING_LOG) == fmt::format("new\nTest message{}", spdlog::details::os::default_eol));
+    REQUIRE(count_files("test_logs") == 2);
+}
@@ -0,0 +1,221 @@
+/*
+ * This content is released under the MIT License as specified in https://raw.githubusercontent.com/gabime/spdlog/master/LICENSE
+ */
+#include "includes.h"
+#include "spdlog/sinks/gzip_file_sink.h"
+
+#ifndef _WIN32
+#    include <csignal>
+#    include <sys/resource.h>
+#endif
+
+#define GZIP_LOG "test_logs/gzip_log.txt.gz"
+
+// decompress a file holding any number of gzip members
+static std::string gunzip_contents(const std::string &filename)
+{
+    gzFile in = gzopen(filename.c_str(), "rb");
+    REQUIRE(in != nullptr);
+    std::string contents;
+    char buf[4096];
+    int n;
+    while ((n = gzread(in, buf, sizeof(buf))) > 0)
+    {
+        contents.append(buf, static_cast<size_t>(n));
+    }
+    REQUIRE(n == 0);
+    gzclose(in);
+    return contents;
+}
+
+// count the gzip members of a file, by decoding them one by one
+static size_t count_gzip_members(const std::string &filename)
+{
+    std::string data = file_contents(filename);
+    size_t members = 0;
+    z_stream stream{};
+    REQUIRE(inflateInit2(&stream, 16 + MAX_WBITS) == Z_OK);
+    stream.next_in = reinterpret_cast<Bytef *>(&data[0]);
+    stream.avail_in = static_cast<uInt>(data.size());
+    char out[4096];
+    while (stream.avail_in > 0)
+    {
+        stream.next_out = reinterpret_cast<Bytef *>(out);
+        stream.avail_out = sizeof(out);
+        int rv = inflate(&stream, Z_NO_FLUSH);
+        REQUIRE((rv == Z_OK || rv == Z_STREAM_END));
+        if (rv == Z_STREAM_END)
+        {
+            members++;
+            inflateReset(&stream);
+        }
+    }
+    inflateEnd(&stream);
+    return members;
+}
+
+static std::string expected_messages(int from, int to)
+{
+    std::string expected;
+    for (int i = from; i < to; ++i)
+    {
+        expected += fmt::format("Test message {}{}", i, spdlog::details::os::default_eol);
+    }
+    return expected;
+}
+
+TEST_CASE("gzip_file_logger", "[gzip_logger]")
+{
+    prepare_logdir();
+    {
+        auto logger = spdlog::gzip_logger_mt("gzip_logger", SPDLOG_FILENAME_T(GZIP_LOG));
+        logger->set_pattern("%v");
+        logger->info("Test message {}", 0);
+        logger->info("Test message {}", 1);
+
+        // flushing makes the messages readable before the file is closed
+        logger->flush();
+        REQUIRE(gunzip_contents(GZIP_LOG) == expected_messages(0, 2));
+        spdlog::drop("gzip_logger");
+    }
+    REQUIRE(gunzip_contents(GZIP_LOG) == expected_messages(0, 2));
+    REQUIRE(count_gzip_members(GZIP_LOG) == 1);
+}
+
+TEST_CASE("gzip_file_logger members", "[gzip_logger]")
+{
+    prepare_logdir();
+    size_t member_size = 1024;
+    {
+        auto sink = std::make_shared<spdlog::sinks::gzip_file_sink_st>(SPDLOG_FILENAME_T(GZIP_LOG), true, member_size);
+        spdlog::logger logger("gzip_logger", sink);
+        logger.set_pattern("%v");
+        for (int i = 0; i < 1000; ++i)
+        {
+            logger.info("Test message {}", i);
+        }
+    }
+
+    auto expected = expected_messages(0, 1000);
+    REQUIRE(gunzip_contents(GZIP_LOG) == expected);
+    REQUIRE(count_gzip_members(GZIP_LOG) == (expected.size() + member_size - 1) / member_size);
+
+    // appending adds members after the existing ones
+    {
+        auto sink = std::make_shared<spdlog::sinks::gzip_file_sink_st>(SPDLOG_FILENAME_T(GZIP_LOG), false, member_size);
+        spdlog::logger logger("gzip_logger", sink);
+        logger.set_pattern("%v");
+        for (int i = 1000; i < 1010; ++i)
+        {
+            logger.info("Test message {}", i);
+        }
+    }
+    REQUIRE(gunzip_contents(GZIP_LOG) == expected_messages(0, 1010));
+}
+
+#if !defined(_WIN32) && !defined(SPDLOG_NO_EXCEPTIONS)
+TEST_CASE("gzip_file_logger failed write", "[gzip_logger]")
+{
+    prepare_logdir();
+    // incompressible, so that most of it is written at once, in the middle of a member
+    std::string big;
+    uint32_t x = 12345;
+    for (int i = 0; i < 64 * 1024; i++)
+    {
+        x = x * 1103515245 + 12345;
+        big += static_cast<char>('a' + (x >> 16) % 26);
+        big += static_cast<char>(x >> 24);
+    }
+    {
+        auto sink = std::make_shared<spdlog::sinks::gzip_file_sink_st>(SPDLOG_FILENAME_T(GZIP_LOG), true, 4 * big.size());
+        spdlog::logger logger("gzip_logger", sink);
+        logger.set_pattern("%v");
+
+        // the file size limit stops the write of the member
+        struct rlimit limit;
+        REQUIRE(::getrlimit(RLIMIT_FSIZE, &limit) == 0);
+        auto old_limit = limit;
+        auto old_handler = ::signal(SIGXFSZ, SIG_IGN);
+        limit.rlim_cur = 1000;
+        REQUIRE(::setrlimit(RLIMIT_FSIZE, &limit) == 0);
+        REQUIRE_THROWS_AS(sink->log(spdlog::details::log_msg("gzip_logger", spdlog::level::info, big)), spdlog::spdlog_ex);
+        REQUIRE(::setrlimit(RLIMIT_FSIZE, &old_limit) == 0);
+        ::signal(SIGXFSZ, old_handler);
+
+        logger.info("Test message {}", 0);
+    }
+
+    // the cut member is followed by a new one, holding only the next message
+    auto data = file_contents(GZIP_LOG);
+    REQUIRE(data.size() > 1000);
+    {
+        std::ofstream ofs("test_logs/last_member.gz", std::ios::binary);
+        ofs << data.substr(data.rfind("\x1f\x8b\x08"));
+    }
+    REQUIRE(gunzip_contents("test_logs/last_member.gz") == expected_messages(0, 1));
+}
+#endif
+
+#ifdef SPDLOG_ZLIB
+TEST_CASE("rotating_file_logger compress rotation", "[rotating_logger]")
+{
+    prepare_logdir();
+    size_t max_size = 1024;
+    size_t max_files = 20;
+    spdlog::filename_t basename = SPDLOG_FILENAME_T("test_logs/rotating_log.txt");
+    {
+        auto logger = spdlog::rotating_logger_mt("logger", basename, max_size, max_files, false, spdlog::sinks::rotation_mode::compress);
+        logger->set_pattern("%v");
+        for (int i = 0; i < 200; ++i)
+        {
+            logger->info("Test message {}", i);
+        }
+        spdlog::drop(logger->name());
+    }
+
+    // every rotated file was compressed, and they hold every message in order
+    size_t files = 1;
+    for (; files <= max_files; files++)
+    {
+        auto filename = spdlog::sinks::rotating_file_sink_st::calc_filename(basename, files);
+        REQUIRE_FALSE(spdlog::details::os::path_exists(filename));
+        if (!spdlog::details::os::path_exists(filename + ".gz"))
+        {
+            break;
+        }
+    }
+    REQUIRE(files > 2);
+    REQUIRE(count_files("test_logs") == files);
+
+    std::string contents;
+    for (size_t i = files - 1; i > 0; i--)
+    {
+        contents += gunzip_contents(spdlog::sinks::rotating_file_sink_st::calc_filename(basename, i) + ".gz");
+    }
+    contents += file_contents(basename);
+    REQUIRE(contents == expected_messages(0, 200));
+}
+
+TEST_CASE("rotating_file_logger compresses a rotated file left uncompressed", "[rotating_logger]")
+{
+    prepare_logdir();
+    // a crash, or a full disk, before log.1.txt was compressed
+    spdlog::details::os::create_dir(SPDLOG_FILENAME_T("test_logs"));
+    {
+        std::ofstream("test_logs/rotating_log.txt") << "current\n";
+        std::ofstream("test_logs/rotating_log.1.txt") << "rotated\n";
+        std::ofstream("test_logs/rotating_log.1.txt.gz") << "partial";
+    }
+    {
+        auto logger = spdlog::rotating_logger_mt(
+            "logger", SPDLOG_FILENAME_T("test_logs/rotating_log.txt"), 1, 3, false, spdlog::sinks::rotation_mode::compress);
+        logger->set_pattern("%v");
+        logger->info("Test message");
+        spdlog::drop(logger->name());
+    }
+    REQUIRE(gunzip_contents("test_logs/rotating_log.2.txt.gz") == "rotated\n");
+    REQUIRE(gunzip_contents("test_logs/rotating_log.1.txt.gz") == "current\n");
+    REQUIRE(file_contents("test_logs/rotating_log.txt") == fmt::format("Test message{}", spdlog::details::os::default_eol));
+    REQUIRE(count_files("test_logs") == 3);
+}
+#endif
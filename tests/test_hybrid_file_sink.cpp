@@ -0,0 +1,214 @@
+/*
+ * This content is released under the MIT License as specified in https://raw.githubusercontent.com/gabime/spdlog/master/LICENSE
+ */
+#include "includes.h"
+#include "spdlog/sinks/hybrid_file_sink.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#    include <sys/utime.h>
+#else
+#    include <utime.h>
+#endif
+
+#define HYBRID_LOG "test_logs/hybrid_log.txt"
+
+using spdlog::sinks::hybrid_file_sink_config;
+using spdlog::sinks::hybrid_file_sink_st;
+
+// the files of the sink, oldest first
+static std::vector<std::string> hybrid_files()
+{
+    std::vector<std::pair<uint64_t, std::string>> files;
+    for (auto &name : spdlog::details::os::dir_entries(SPDLOG_FILENAME_T("test_logs")))
+    {
+        auto filename = spdlog::details::os::filename_to_str(name);
+        // hybrid_log_2024-01-31_13-00-00.17.txt
+        auto seq_pos = filename.rfind('.', filename.size() - 5);
+        files.emplace_back(std::stoull(filename.substr(seq_pos + 1)), "test_logs/" + filename);
+    }
+    std::sort(files.begin(), files.end());
+    std::vector<std::string> result;
+    for (auto &file : files)
+    {
+        result.push_back(file.second);
+    }
+    return result;
+}
+
+static void log_at(hybrid_file_sink_st &sink, spdlog::log_clock::time_point tp, int i)
+{
+    auto msg = fmt::format("Test message {}", i);
+    sink.log(spdlog::details::log_msg(tp, spdlog::source_loc{}, "test", spdlog::level::info, msg));
+}
+
+TEST_CASE("hybrid_file_sink calc_filename", "[hybrid_logger]")
+{
+    std::tm tm = spdlog::details::os::localtime();
+    tm.tm_year = 124;
+    tm.tm_mon = 0;
+    tm.tm_mday = 31;
+    tm.tm_hour = 13;
+    tm.tm_min = 5;
+    tm.tm_sec = 9;
+    auto filename = hybrid_file_sink_st::calc_filename(SPDLOG_FILENAME_T("logs/app.log"), tm, 17);
+    REQUIRE(filename == SPDLOG_FILENAME_T("logs/app_2024-01-31_13-05-09.17.log"));
+}
+
+TEST_CASE("hybrid_file_logger rotation by size", "[hybrid_logger]")
+{
+    prepare_logdir();
+    hybrid_file_sink_config config(SPDLOG_FILENAME_T(HYBRID_LOG));
+    config.max_size = 1024;
+    std::string first_file;
+    {
+        auto logger = spdlog::hybrid_logger_mt("logger", config);
+        logger->set_pattern("%v");
+        auto sink = std::static_pointer_cast<spdlog::sinks::hybrid_file_sink_mt>(logger->sinks()[0]);
+        first_file = spdlog::details::os::filename_to_str(sink->filename());
+        for (int i = 0; i < 200; ++i)
+        {
+            logger->info("Test message {}", i);
+        }
+        spdlog::drop(logger->name());
+    }
+
+    // the files were never renamed, and hold every message in order
+    auto files = hybrid_files();
+    REQUIRE(files.size() > 2);
+    REQUIRE(files.front() == first_file);
+    std::string contents;
+    for (auto &file : files)
+    {
+        REQUIRE(get_filesize(file) <= config.max_size);
+        contents += file_contents(file);
+    }
+    std::string expected;
+    for (int i = 0; i < 200; ++i)
+    {
+        expected += fmt::format("Test message {}{}", i, spdlog::details::os::default_eol);
+    }
+    REQUIRE(contents == expected);
+}
+
+TEST_CASE("hybrid_file_logger rotation by time", "[hybrid_logger]")
+{
+    prepare_logdir();
+    hybrid_file_sink_config config(SPDLOG_FILENAME_T(HYBRID_LOG));
+    config.rotation_interval = std::chrono::seconds(60);
+    // the start of the current minute
+    auto since_epoch = spdlog::log_clock::now().time_since_epoch();
+    auto minute = spdlog::log_clock::time_point(std::chrono::duration_cast<std::chrono::minutes>(since_epoch));
+    {
+        hybrid_file_sink_st sink(config);
+        sink.set_pattern("%v");
+        log_at(sink, minute + std::chrono::seconds(1), 0);
+        log_at(sink, minute + std::chrono::seconds(2), 1);
+        // the next minute starts a new file, and so does the one after
+        log_at(sink, minute + std::chrono::seconds(61), 2);
+        log_at(sink, minute + std::chrono::seconds(121), 3);
+        log_at(sink, minute + std::chrono::seconds(122), 4);
+    }
+
+    auto files = hybrid_files();
+    REQUIRE(files.size() == 3);
+    using spdlog::details::os::default_eol;
+    REQUIRE(file_contents(files[0]) == fmt::format("Test message 0{}Test message 1{}", default_eol, default_eol));
+    REQUIRE(file_contents(files[1]) == fmt::format("Test message 2{}", default_eol));
+    REQUIRE(file_contents(files[2]) == fmt::format("Test message 3{}Test message 4{}", default_eol, default_eol));
+}
+
+TEST_CASE("hybrid_file_logger retention by total size", "[hybrid_logger]")
+{
+    prepare_logdir();
+    hybrid_file_sink_config config(SPDLOG_FILENAME_T(HYBRID_LOG));
+    config.max_size = 1024;
+    config.max_total_size = 4096;
+    {
+        hybrid_file_sink_st sink(config);
+        sink.set_pattern("%v");
+        auto now = spdlog::log_clock::now();
+        for (int i = 0; i < 1000; ++i)
+        {
+            log_at(sink, now, i);
+        }
+    }
+
+    // the oldest files were deleted, and the newest messages kept
+    auto files = hybrid_files();
+    size_t total = 0;
+    for (auto &file : files)
+    {
+        total += get_filesize(file);
+    }
+    REQUIRE(total <= config.max_total_size);
+    REQUIRE(total > config.max_total_size - 2 * config.max_size);
+    REQUIRE(file_contents(files.back()).find("Test message 999") != std::string::npos);
+}
+
+// a file of a previous run, started age ago, last written last_write_age ago
+static spdlog::filename_t old_file(spdlog::log_clock::time_point now, std::chrono::seconds age, std::chrono::seconds last_write_age, uint64_t seq)
+{
+    auto tm = spdlog::details::os::localtime(spdlog::log_clock::to_time_t(now - age));
+    auto filename = hybrid_file_sink_st::calc_filename(SPDLOG_FILENAME_T(HYBRID_LOG), tm, seq);
+    {
+        spdlog::details::file_helper helper;
+        helper.open(filename);
+    }
+    auto mtime = spdlog::log_clock::to_time_t(now - last_write_age);
+#ifdef _WIN32
+    struct _utimbuf times{mtime, mtime};
+    REQUIRE(::_utime(spdlog::details::os::filename_to_str(filename).c_str(), &times) == 0);
+#else
+    struct utimbuf times{mtime, mtime};
+    REQUIRE(::utime(filename.c_str(), &times) == 0);
+#endif
+    return filename;
+}
+
+TEST_CASE("hybrid_file_logger retention by age", "[hybrid_logger]")
+{
+    prepare_logdir();
+    hybrid_file_sink_config config(SPDLOG_FILENAME_T(HYBRID_LOG));
+    config.max_age = std::chrono::hours(1);
+
+    // files of a previous run: started a day ago, an hour ago, and just now,
+    // each written until the next one started
+    auto now = spdlog::log_clock::now();
+    auto day_old = old_file(now, std::chrono::hours(24), std::chrono::minutes(70), 5);
+    auto hour_old = old_file(now, std::chrono::minutes(70), std::chrono::seconds(10), 6);
+    auto recent = old_file(now, std::chrono::seconds(10), std::chrono::seconds(0), 41);
+
+    spdlog::filename_t current;
+    {
+        hybrid_file_sink_st sink(config);
+        current = sink.filename();
+    }
+
+    // the first file's last message is more than an hour old
+    REQUIRE_FALSE(spdlog::details::os::path_exists(day_old));
+    // the second's is as recent as the start of the third
+    REQUIRE(spdlog::details::os::path_exists(hour_old));
+    REQUIRE(spdlog::details::os::path_exists(recent));
+    // and the sequence goes on from the previous run
+    REQUIRE(current.find(SPDLOG_FILENAME_T(".42.txt")) != spdlog::filename_t::npos);
+}
+
+TEST_CASE("hybrid_file_logger retention by age after a restart", "[hybrid_logger]")
+{
+    prepare_logdir();
+    hybrid_file_sink_config config(SPDLOG_FILENAME_T(HYBRID_LOG));
+    config.max_age = std::chrono::hours(1);
+
+    // the last run stopped two hours ago: its newest file is as old as its last message
+    auto now = spdlog::log_clock::now();
+    auto older = old_file(now, std::chrono::hours(3), std::chrono::minutes(150), 1);
+    auto newest = old_file(now, std::chrono::minutes(150), std::chrono::hours(2), 2);
+    {
+        hybrid_file_sink_st sink(config);
+    }
+    REQUIRE_FALSE(spdlog::details::os::path_exists(older));
+    REQUIRE_FALSE(spdlog::details::os::path_exists(newest));
+    REQUIRE(hybrid_files().size() == 1);
+}
@@ -0,0 +1,688 @@
+#include "includes.h"
+#include "spdlog/json_formatter.h"
+#include "spdlog/binary_formatter.h"
+
+using spdlog::json_serializer;
+using spdlog::memory_buf_t;
+
+static std::string format_json(const spdlog::details::log_msg &msg, json_serializer serializer,
+    spdlog::populators::populator_set &&populators = spdlog::populators::populator_set())
+{
+    memory_buf_t buf;
+    if (populators.empty())
+    {
+        spdlog::json_formatter(spdlog::details::os::default_eol, serializer).format(msg, buf);
+    }
+    else
+    {
+        spdlog::json_formatter(std::move(populators), spdlog::details::os::default_eol, serializer).format(msg, buf);
+    }
+    return std::string(buf.data(), buf.size() - strlen(spdlog::details::os::default_eol));
+}
+
+static std::string escape(spdlog::string_view_t text)
+{
+    memory_buf_t buf;
+    spdlog::json_writer::write_string(text, buf);
+    return std::string(buf.data(), buf.size());
+}
+
+TEST_CASE("stream and dom serializers agree", "[json_formatter]")
+{
+    nlohmann::json params = {{"user_id", 42}, {"latency_us", 3.25}, {"ok", true}, {"nested", {{"a", {1, 2, 3}}}}, {"none", nullptr}};
+    spdlog::details::log_msg msg(spdlog::source_loc{"file.cpp", 7, "func"}, "json-logger", spdlog::level::warn, "some \"quoted\" text\n");
+    msg.params = &params;
+
+    auto stream = nlohmann::json::parse(format_json(msg, json_serializer::stream));
+    auto dom = nlohmann::json::parse(format_json(msg, json_serializer::dom));
+    REQUIRE(stream == dom);
+    REQUIRE(stream["message"] == "some \"quoted\" text\n");
+    REQUIRE(stream["level"] == "warning");
+    REQUIRE(stream["logger_name"] == "json-logger");
+    REQUIRE(stream["user_id"] == 42);
+}
+
+TEST_CASE("params override populator fields", "[json_formatter]")
+{
+    nlohmann::json params = {{"message", "overridden"}};
+    spdlog::details::log_msg msg("", spdlog::level::info, "original");
+    msg.params = &params;
+
+    auto populators = spdlog::populators::make_populator_set(spdlog::details::make_unique<spdlog::populators::message_populator>(),
+        spdlog::details::make_unique<spdlog::populators::level_populator>());
+    REQUIRE(format_json(msg, json_serializer::stream, std::move(populators)) == R"({"level":"info","message":"overridden"})");
+}
+
+TEST_CASE("populators without a streaming override", "[json_formatter]")
+{
+    spdlog::details::log_msg msg("", spdlog::level::info, "text");
+    auto populators = spdlog::populators::make_populator_set(
+        spdlog::details::make_unique<spdlog::populators::pattern_populator>("pattern", "[%l] %v"));
+    REQUIRE(format_json(msg, json_serializer::stream, std::move(populators)) == R"({"pattern":"[info] text"})");
+}
+
+TEST_CASE("json string escaping", "[json_formatter]")
+{
+    REQUIRE(escape("") == R"("")");
+    REQUIRE(escape("plain text") == R"("plain text")");
+    REQUIRE(escape("\"\\\b\f\n\r\t") == R"("\"\\\b\f\n\r\t")");
+    REQUIRE(escape(spdlog::string_view_t("\x01\x1f\x00", 3)) == R"("\u0001\u001f\u0000")");
+    REQUIRE(escape("\x7f") == "\"\x7f\"");
+    REQUIRE(escape("caf\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80") == "\"caf\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80\"");
+}
+
+TEST_CASE("json string escaping replaces invalid utf-8", "[json_formatter]")
+{
+    // lone continuation byte, overlong encoding, surrogate, truncated sequence
+    REQUIRE(escape("a\x80z") == "\"a\xEF\xBF\xBDz\"");
+    REQUIRE(escape("\xC0\xAF") == "\"\xEF\xBF\xBD\xEF\xBF\xBD\"");
+    REQUIRE(escape("\xED\xA0\x80") == "\"\xEF\xBF\xBD\xEF\xBF\xBD\xEF\xBF\xBD\"");
+    REQUIRE(escape("ok\xE2\x82") == "\"ok\xEF\xBF\xBD\"");
+    REQUIRE(escape("\xE2\x82z") == "\"\xEF\xBF\xBDz\"");
+}
+
+TEST_CASE("json string escaping across vector blocks", "[json_formatter]")
+{
+    // every special byte at every offset of strings spanning several 16 and 32 byte blocks
+    const std::vector<std::string> specials = {"\"", "\\", "\n", std::string(1, '\0'), "\x1f", "\xC3\xA9", "\xF0\x9F\x98\x80", "\x80"};
+    for (const auto &special : specials)
+    {
+        for (size_t pos = 0; pos <= 70; ++pos)
+        {
+            std::string text(70, 'x');
+            text.insert(pos, special);
+            auto expected = nlohmann::json(text).dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+            REQUIRE(escape(text) == expected);
+        }
+    }
+}
+
+TEST_CASE("json numbers match nlohmann", "[json_formatter]")
+{
+    for (double d : {0.0, -0.0, 1.0, 3.25, -1e-7, 1e20, 123456789.125, 0.1})
+    {
+        memory_buf_t buf;
+        spdlog::json_writer::write_double(d, buf);
+        REQUIRE(std::string(buf.data(), buf.size()) == nlohmann::json(d).dump());
+    }
+    memory_buf_t buf;
+    spdlog::json_writer::write_double(std::numeric_limits<double>::quiet_NaN(), buf);
+    REQUIRE(std::string(buf.data(), buf.size()) == "null");
+}
+
+TEST_CASE("stream serializer writes fields in populator order", "[json_formatter]")
+{
+    nlohmann::json params = {{"b", 2}, {"a", 1}};
+    spdlog::details::log_msg msg("name", spdlog::level::err, "text");
+    msg.params = &params;
+
+    auto populators = spdlog::populators::make_populator_set(spdlog::details::make_unique<spdlog::populators::message_populator>(),
+        spdlog::details::make_unique<spdlog::populators::logger_name_populator>(),
+        spdlog::details::make_unique<spdlog::populators::level_populator>());
+    REQUIRE(format_json(msg, json_serializer::stream, std::move(populators)) ==
+            R"({"message":"text","logger_name":"name","level":"error","a":1,"b":2})");
+}
+
+TEST_CASE("the compiled plan writes the built-in populators as their write() does", "[json_formatter]")
+{
+    spdlog::details::log_msg msg("name", spdlog::level::info, "text");
+    auto make_populators = [] {
+        return spdlog::populators::make_populator_set(spdlog::details::make_unique<spdlog::populators::pattern_populator>("pattern", "[%l] %v"),
+            spdlog::details::make_unique<spdlog::populators::date_time_populator>(spdlog::timestamp_format::epoch_micros),
+            spdlog::details::make_unique<spdlog::populators::level_populator>(),
+            spdlog::details::make_unique<spdlog::populators::logger_name_populator>(),
+            spdlog::details::make_unique<spdlog::populators::message_populator>(),
+            spdlog::details::make_unique<spdlog::populators::pid_populator>(),
+            spdlog::details::make_unique<spdlog::populators::thread_id_populator>(),
+            spdlog::details::make_unique<spdlog::populators::timestamp_populator>());
+    };
+
+    spdlog::json_writer writer;
+    memory_buf_t expected;
+    writer.begin_object(expected);
+    for (const auto &populator : make_populators())
+    {
+        populator->write(msg, writer);
+    }
+    writer.end_object();
+    REQUIRE(format_json(msg, json_serializer::stream, make_populators()) == std::string(expected.data(), expected.size()));
+}
+
+// a built-in populator with its own output: opts out of the plan so that its write() is called
+class shouting_message_populator : public spdlog::populators::message_populator
+{
+public:
+    void write(const spdlog::details::log_msg &msg, spdlog::json_writer &dest) override
+    {
+        dest.field("message", fmt::format("{}!", msg.payload));
+    }
+
+    spdlog::populators::field_plan plan() const override
+    {
+        return spdlog::populators::field_plan();
+    }
+};
+
+TEST_CASE("the compiled plan calls populators that opt out of it", "[json_formatter]")
+{
+    spdlog::details::log_msg msg("", spdlog::level::info, "text");
+    auto populators = spdlog::populators::make_populator_set(spdlog::details::make_unique<spdlog::populators::level_populator>(),
+        spdlog::details::make_unique<shouting_message_populator>());
+    REQUIRE(format_json(msg, json_serializer::stream, std::move(populators)) == R"({"level":"info","message":"text!"})");
+}
+
+TEST_CASE("json_key renders escaped keys", "[json_formatter]")
+{
+    spdlog::json_key key("a \"key\"");
+    REQUIRE(key.name() == "a \"key\"");
+    REQUIRE(std::string(key.rendered().data(), key.rendered().size()) == R"("a \"key\"":)");
+}
+
+static std::string render_timestamp(spdlog::details::timestamp_renderer &renderer, spdlog::log_clock::time_point tp)
+{
+    memory_buf_t buf;
+    renderer.render(tp, buf);
+    return std::string(buf.data(), buf.size());
+}
+
+static std::string format_pattern(const std::string &pattern, spdlog::pattern_time_type time_type, spdlog::log_clock::time_point tp)
+{
+    spdlog::details::log_msg msg(tp, spdlog::source_loc{}, "", spdlog::level::info, "");
+    memory_buf_t buf;
+    spdlog::pattern_formatter(pattern, time_type, "").format(msg, buf);
+    return std::string(buf.data(), buf.size());
+}
+
+TEST_CASE("timestamp renderer matches pattern_formatter", "[json_formatter]")
+{
+    using spdlog::timestamp_format;
+    auto now = spdlog::log_clock::now();
+    for (auto time_type : {spdlog::pattern_time_type::local, spdlog::pattern_time_type::utc})
+    {
+        spdlog::details::timestamp_renderer date_time(timestamp_format::date_time, time_type);
+        spdlog::details::timestamp_renderer rfc3339(timestamp_format::rfc3339_nanos, time_type);
+        // the second render of each second hits the cache
+        for (auto tp : {now, now + std::chrono::milliseconds(7), now + std::chrono::seconds(1), now + std::chrono::hours(5000)})
+        {
+            REQUIRE(render_timestamp(date_time, tp) == format_pattern("%Y-%m-%d %H:%M:%S.%e%z", time_type, tp));
+            REQUIRE(render_timestamp(rfc3339, tp) == format_pattern("%Y-%m-%dT%H:%M:%S.%F%z", time_type, tp));
+        }
+    }
+
+    spdlog::details::timestamp_renderer epoch(timestamp_format::epoch_micros);
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
+    REQUIRE(render_timestamp(epoch, now) == std::to_string(micros));
+}
+
+static std::string log_typed_fields(json_serializer serializer)
+{
+    std::ostringstream oss;
+    auto oss_sink = std::make_shared<spdlog::sinks::ostream_sink_st>(oss);
+    spdlog::logger oss_logger("oss", oss_sink);
+    auto populators = spdlog::populators::make_populator_set(spdlog::details::make_unique<spdlog::populators::message_populator>());
+    oss_logger.set_formatter(spdlog::details::make_unique<spdlog::json_formatter>(std::move(populators), "", serializer));
+
+    std::string name = "a \"name\"";
+    oss_logger.info("text")
+        .field("user_id", 42)
+        .field("big", std::numeric_limits<uint64_t>::max())
+        .field("negative", -7L)
+        .field("latency_us", 3.25)
+        .field("ok", true)
+        .field("none", nullptr)
+        .field("name", name)
+        .field("literal", "lit");
+    return oss.str();
+}
+
+TEST_CASE("typed fields", "[json_formatter]")
+{
+    auto stream = log_typed_fields(json_serializer::stream);
+    REQUIRE(stream == R"({"message":"text","user_id":42,"big":18446744073709551615,"negative":-7,"latency_us":3.25,"ok":true,)"
+                      R"("none":null,"name":"a \"name\"","literal":"lit"})");
+    REQUIRE(nlohmann::json::parse(stream) == nlohmann::json::parse(log_typed_fields(json_serializer::dom)));
+}
+
+TEST_CASE("typed fields override params and populator fields", "[json_formatter]")
+{
+    std::ostringstream oss;
+    auto oss_sink = std::make_shared<spdlog::sinks::ostream_sink_st>(oss);
+    spdlog::logger oss_logger("oss", oss_sink);
+    oss_logger.set_populators(spdlog::details::make_unique<spdlog::populators::message_populator>(),
+        spdlog::details::make_unique<spdlog::populators::logger_name_populator>());
+
+    oss_logger.info("text")({{"message", "from params"}, {"a", 1}}).field("logger_name", "typed").field("a", 2);
+    REQUIRE(oss.str() == R"({"message":"from params","logger_name":"typed","a":2})" + std::string(spdlog::details::os::default_eol));
+}
+
+TEST_CASE("temporary params are moved into the entry", "[json_formatter]")
+{
+    std::ostringstream oss;
+    auto oss_sink = std::make_shared<spdlog::sinks::ostream_sink_st>(oss);
+    spdlog::logger oss_logger("oss", oss_sink);
+    oss_logger.set_populators(spdlog::details::make_unique<spdlog::populators::message_populator>());
+
+    nlohmann::json first = {{"a", 1}, {"b", "moved"}};
+    nlohmann::json second = {{"b", {1, 2}}, {"c", nullptr}};
+    const nlohmann::json kept = {{"d", true}};
+    oss_logger.info("text")(std::move(first))(std::move(second))(kept);
+    REQUIRE(first.is_null());
+    REQUIRE(second["b"].is_null());
+    REQUIRE(kept["d"] == true);
+    REQUIRE(oss.str() == R"({"message":"text","a":1,"b":[1,2],"c":null,"d":true})" + std::string(spdlog::details::os::default_eol));
+}
+
+TEST_CASE("typed fields survive log_msg_buffer copies", "[json_formatter]")
+{
+    spdlog::details::log_msg msg("name", spdlog::level::info, "text");
+    spdlog::details::log_msg_buffer buffer(msg);
+    buffer.add_field("user_id", int64_t{42});
+    buffer.add_field("host", spdlog::string_view_t("localhost"));
+
+    spdlog::details::log_msg_buffer copy(buffer);
+    spdlog::details::log_msg_buffer moved(std::move(buffer));
+    spdlog::details::log_msg_buffer assigned;
+    assigned = copy;
+    for (const spdlog::details::log_msg *m : {static_cast<spdlog::details::log_msg *>(&copy), static_cast<spdlog::details::log_msg *>(&moved),
+             static_cast<spdlog::details::log_msg *>(&assigned)})
+    {
+        REQUIRE(std::string(m->payload.data(), m->payload.size()) == "text");
+        REQUIRE(format_json(*m, json_serializer::stream, spdlog::populators::make_populator_set(
+                                                              spdlog::details::make_unique<spdlog::populators::message_populator>())) ==
+                R"({"message":"text","user_id":42,"host":"localhost"})");
+    }
+}
+
+TEST_CASE("lazy params are only built for enabled levels", "[json_formatter]")
+{
+    std::ostringstream oss;
+    auto oss_sink = std::make_shared<spdlog::sinks::ostream_sink_st>(oss);
+    spdlog::logger oss_logger("oss", oss_sink);
+    oss_logger.set_populators(spdlog::details::make_unique<spdlog::populators::message_populator>());
+    oss_logger.set_level(spdlog::level::info);
+
+    int calls = 0;
+    auto params = [&calls]() -> nlohmann::json {
+        ++calls;
+        return {{"calls", calls}};
+    };
+    auto fields = [&calls](spdlog::details::executor &executor) { executor.field("calls", ++calls); };
+
+    REQUIRE_FALSE(oss_logger.debug("hidden").enabled());
+    oss_logger.debug("hidden")(params)(fields);
+    SPDLOG_LOGGER_DEBUG(&oss_logger, "hidden")(SPDLOG_LAZY_PARAMS({{"calls", ++calls}}));
+    REQUIRE(calls == 0);
+    REQUIRE(oss.str().empty());
+
+    oss_logger.info("shown")(params);
+    oss_logger.info("shown")(fields);
+    REQUIRE(calls == 2);
+    auto eol = std::string(spdlog::details::os::default_eol);
+    REQUIRE(oss.str() == R"({"message":"shown","calls":1})" + eol + R"({"message":"shown","calls":2})" + eol);
+}
+
+TEST_CASE("async logger keeps params and typed fields", "[json_formatter]")
+{
+    std::ostringstream oss;
+    auto oss_sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(oss);
+    oss_sink->set_populators(spdlog::details::make_unique<spdlog::populators::message_populator>());
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(16, 1);
+        auto logger = std::make_shared<spdlog::async_logger>("as", oss_sink, tp);
+        logger->enable_backtrace(4);
+        for (int i = 0; i < 3; i++)
+        {
+            logger->info("msg")({{"i", i}, {"tags", {"a", "b"}}}).field("n", i * 2);
+        }
+        logger->debug("traced")({{"i", 3}});
+        logger->dump_backtrace();
+    }
+    auto eol = std::string(spdlog::details::os::default_eol);
+    auto expected = std::string(R"({"message":"msg","i":0,"tags":["a","b"],"n":0})") + eol + R"({"message":"msg","i":1,"tags":["a","b"],"n":2})" + eol +
+                    R"({"message":"msg","i":2,"tags":["a","b"],"n":4})" + eol;
+    REQUIRE(oss.str().substr(0, expected.size()) == expected);
+    REQUIRE(oss.str().find(R"({"message":"traced","i":3})") != std::string::npos);
+}
+
+static spdlog::populators::populator_set all_populators()
+{
+    return spdlog::populators::make_populator_set(
+        spdlog::details::make_unique<spdlog::populators::date_time_populator>(spdlog::timestamp_format::rfc3339_nanos),
+        spdlog::details::make_unique<spdlog::populators::level_populator>(),
+        spdlog::details::make_unique<spdlog::populators::logger_name_populator>(),
+        spdlog::details::make_unique<spdlog::populators::thread_id_populator>(),
+        spdlog::details::make_unique<spdlog::populators::src_loc_populator>(),
+        spdlog::details::make_unique<spdlog::populators::message_populator>());
+}
+
+TEST_CASE("binary records decode to the same json", "[binary_formatter]")
+{
+    nlohmann::json params = {{"user_id", 42}, {"neg", -7}, {"ratio", 0.1}, {"nested", {{"a", {1, "two", nullptr}}}}};
+    std::vector<spdlog::details::log_msg_buffer> msgs;
+    {
+        spdlog::details::log_msg msg(spdlog::source_loc{"file.cpp", 7, "func"}, "first", spdlog::level::warn, "with \"params\"");
+        msg.params = &params;
+        msgs.emplace_back(msg);
+        msgs.back().add_field("typed", int64_t{-3});
+        msgs.back().add_field("text", spdlog::string_view_t("x\ny"));
+    }
+    msgs.emplace_back(spdlog::details::log_msg("second", spdlog::level::info, "plain"));
+    msgs.emplace_back(spdlog::details::log_msg("", spdlog::level::err, "no name"));
+    msgs.emplace_back(spdlog::details::log_msg("first", spdlog::level::trace, "first again"));
+
+    spdlog::json_formatter json(all_populators());
+    spdlog::binary_formatter binary;
+    memory_buf_t expected;
+    memory_buf_t encoded;
+    for (const auto &msg : msgs)
+    {
+        json.format(msg, expected);
+        binary.format(msg, encoded);
+    }
+
+    // feed the records in two chunks, splitting one of them
+    spdlog::json_formatter decoded_json(all_populators());
+    spdlog::binary_decoder decoder;
+    memory_buf_t decoded;
+    auto sink = [&](const spdlog::details::log_msg &msg) { decoded_json.format(msg, decoded); };
+    const size_t split = encoded.size() / 2;
+    auto consumed = decoder.decode(spdlog::string_view_t(encoded.data(), split), sink);
+    REQUIRE(consumed < split);
+    std::string rest(encoded.data() + consumed, encoded.size() - consumed);
+    REQUIRE(decoder.decode(rest, sink) == rest.size());
+
+    REQUIRE(std::string(decoded.data(), decoded.size()) == std::string(expected.data(), expected.size()));
+}
+
+TEST_CASE("binary formatter writes each logger name once", "[binary_formatter]")
+{
+    spdlog::binary_formatter binary;
+    memory_buf_t first;
+    memory_buf_t second;
+    binary.format(spdlog::details::log_msg("a-rather-long-logger-name", spdlog::level::info, "x"), first);
+    binary.format(spdlog::details::log_msg("a-rather-long-logger-name", spdlog::level::info, "x"), second);
+    REQUIRE(second.size() < first.size());
+
+#ifndef SPDLOG_NO_EXCEPTIONS
+    // a decoder which missed the name record cannot tell the logger name
+    spdlog::binary_decoder decoder;
+    REQUIRE_THROWS_AS(decoder.decode(spdlog::string_view_t(second.data(), second.size()), [](const spdlog::details::log_msg &) {}),
+        spdlog::spdlog_ex);
+#endif
+}
+
+#ifndef SPDLOG_NO_EXCEPTIONS
+TEST_CASE("binary decoder rejects corrupt records", "[binary_formatter]")
+{
+    // a logger name record followed by a message record
+    memory_buf_t encoded;
+    spdlog::binary_formatter().format(spdlog::details::log_msg("name", spdlog::level::info, "x"), encoded);
+    const char *p = encoded.data();
+    const size_t message_start = sizeof(uint32_t) + spdlog::details::log_fields::read_raw<uint32_t>(p);
+
+    auto decode = [](const std::string &data) {
+        size_t messages = 0;
+        spdlog::binary_decoder().decode(data, [&messages](const spdlog::details::log_msg &) { ++messages; });
+        return messages;
+    };
+    const std::string valid(encoded.data(), encoded.size());
+    REQUIRE(decode(valid) == 1);
+
+    // [size][type][time][level]
+    auto bad_level = valid;
+    bad_level[message_start + 4 + 1 + 8] = static_cast<char>(spdlog::level::n_levels);
+    REQUIRE_THROWS_AS(decode(bad_level), spdlog::spdlog_ex);
+
+    // fields appended to the message record, which grows accordingly
+    auto with_fields = [&](const std::string &fields) {
+        auto data = valid + fields;
+        uint32_t size;
+        std::memcpy(&size, data.data() + message_start, sizeof(size));
+        size += static_cast<uint32_t>(fields.size());
+        std::memcpy(&data[message_start], &size, sizeof(size));
+        return data;
+    };
+    REQUIRE(decode(with_fields(std::string("\x01\x01\x00\x00\x00k\x01", 7))) == 1);
+    // truncated value, interned key, unknown type
+    REQUIRE_THROWS_AS(decode(with_fields(std::string("\x02\x01\x00\x00\x00k\x01", 7))), spdlog::spdlog_ex);
+    REQUIRE_THROWS_AS(decode(with_fields(std::string("\x82\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00", 13))), spdlog::spdlog_ex);
+    REQUIRE_THROWS_AS(decode(with_fields(std::string("\x06\x00\x00\x00\x00", 5))), spdlog::spdlog_ex);
+
+    // a huge logger id is only a key
+    memory_buf_t big_id;
+    spdlog::details::log_fields::append_raw(uint32_t{1 + 4 + 4 + 1}, big_id);
+    big_id.push_back(static_cast<char>(spdlog::binary_record::logger_name));
+    spdlog::details::log_fields::append_raw(uint32_t{0xfffffff0}, big_id);
+    spdlog::details::log_fields::append_string("n", big_id);
+    REQUIRE(decode(std::string(big_id.data(), big_id.size())) == 0);
+}
+#endif
+
+static std::string format_encoded(const spdlog::details::log_msg &msg, json_serializer serializer, spdlog::json_encoding encoding)
+{
+    memory_buf_t buf;
+    auto populators = spdlog::populators::make_populator_set(spdlog::details::make_unique<spdlog::populators::level_populator>(),
+        spdlog::details::make_unique<spdlog::populators::message_populator>(),
+        spdlog::details::make_unique<spdlog::populators::thread_id_populator>());
+    spdlog::json_formatter(std::move(populators), spdlog::details::os::default_eol, serializer, encoding).format(msg, buf);
+    return std::string(buf.data(), buf.size());
+}
+
+TEST_CASE("msgpack and cbor encodings decode to the text json", "[json_formatter]")
+{
+    nlohmann::json params = {{"message", "overridden"}, {"nested", {{"a", {1, -2, "three", nullptr}}}}, {"ratio", 0.1}};
+    spdlog::details::log_msg_buffer msg(spdlog::details::log_msg("", spdlog::level::warn, "original"));
+    msg.params = &params;
+    msg.add_field("small", int64_t{-5});
+    msg.add_field("neg", int64_t{-100000});
+    msg.add_field("big", uint64_t{1} << 40);
+    msg.add_field("half", 0.5);
+    msg.add_field("ok", true);
+    msg.add_field("none", nullptr);
+    msg.add_field("long", spdlog::string_view_t(std::string(300, 'x')));
+
+    auto text = nlohmann::json::parse(format_encoded(msg, json_serializer::stream, spdlog::json_encoding::text));
+    for (auto serializer : {json_serializer::stream, json_serializer::dom})
+    {
+        auto msgpack = format_encoded(msg, serializer, spdlog::json_encoding::msgpack);
+        auto cbor = format_encoded(msg, serializer, spdlog::json_encoding::cbor);
+        REQUIRE(nlohmann::json::from_msgpack(msgpack) == text);
+        REQUIRE(nlohmann::json::from_cbor(cbor) == text);
+        REQUIRE(msgpack.size() < text.dump().size());
+    }
+}
+
+TEST_CASE("the last typed field of a key wins", "[json_formatter]")
+{
+    // same time for both messages, so that only the fields can differ
+    auto time = spdlog::log_clock::now();
+    auto with_fields = [time](bool duplicate) {
+        spdlog::details::log_msg_buffer msg(spdlog::details::log_msg(time, spdlog::source_loc{}, "", spdlog::level::info, "text"));
+        if (duplicate)
+        {
+            msg.add_field("a", int64_t{1});
+        }
+        msg.add_field("b", true);
+        msg.add_field(spdlog::field_key("a"), int64_t{2});
+        return msg;
+    };
+    auto duplicated = with_fields(true);
+    auto single = with_fields(false);
+
+    REQUIRE(format_json(duplicated, json_serializer::stream).find(R"("b":true,"a":2})") != std::string::npos);
+    for (auto serializer : {json_serializer::stream, json_serializer::dom})
+    {
+        REQUIRE(format_json(duplicated, serializer) == format_json(single, serializer));
+        REQUIRE(format_encoded(duplicated, serializer, spdlog::json_encoding::msgpack) ==
+                format_encoded(single, serializer, spdlog::json_encoding::msgpack));
+        REQUIRE(format_encoded(duplicated, serializer, spdlog::json_encoding::cbor) ==
+                format_encoded(single, serializer, spdlog::json_encoding::cbor));
+    }
+}
+
+TEST_CASE("binary encodings write one map per message", "[json_formatter]")
+{
+    spdlog::details::log_msg msg("", spdlog::level::info, "hi");
+    auto populators = [] { return spdlog::populators::make_populator_set(spdlog::details::make_unique<spdlog::populators::message_populator>()); };
+    memory_buf_t buf;
+    spdlog::json_formatter(populators(), "\n", json_serializer::stream, spdlog::json_encoding::msgpack).format(msg, buf);
+    REQUIRE(std::string(buf.data(), buf.size()) == std::string("\xdf\x00\x00\x00\x01\xa7message\xa2hi", 16));
+
+    buf.clear();
+    spdlog::json_formatter(populators(), "\n", json_serializer::stream, spdlog::json_encoding::cbor).format(msg, buf);
+    REQUIRE(std::string(buf.data(), buf.size()) == std::string("\xba\x00\x00\x00\x01\x67message\x62hi", 16));
+}
+
+TEST_CASE("interned field keys", "[json_formatter]")
+{
+    spdlog::field_key user_id("user_id");
+    REQUIRE(spdlog::field_key("user_id").id() == user_id.id());
+    REQUIRE(spdlog::field_key("other").id() != user_id.id());
+    REQUIRE(spdlog::field_key("a \"quoted\" key").rendered() == spdlog::string_view_t(R"("a \"quoted\" key":)"));
+
+    auto with_keys = [](spdlog::details::field_name id_key, spdlog::details::field_name message_key) {
+        spdlog::details::log_msg_buffer msg(spdlog::details::log_msg("", spdlog::level::info, "original"));
+        msg.add_field(id_key, int64_t{42});
+        msg.add_field(message_key, spdlog::string_view_t("overridden"));
+        return msg;
+    };
+    auto plain = with_keys("user_id", "message");
+    auto interned = with_keys(user_id, spdlog::field_key("message"));
+    REQUIRE(interned.fields.size() < plain.fields.size());
+
+    for (auto serializer : {json_serializer::stream, json_serializer::dom})
+    {
+        REQUIRE(format_json(interned, serializer) == format_json(plain, serializer));
+        REQUIRE(format_encoded(interned, serializer, spdlog::json_encoding::msgpack) ==
+                format_encoded(plain, serializer, spdlog::json_encoding::msgpack));
+    }
+    REQUIRE(format_json(interned, json_serializer::stream).find(R"("user_id":42,"message":"overridden"})") != std::string::npos);
+
+    // binary records carry the key names, not the process local ids
+    memory_buf_t encoded;
+    spdlog::binary_formatter().format(interned, encoded);
+    memory_buf_t decoded;
+    spdlog::json_formatter json;
+    spdlog::binary_decoder().decode(spdlog::string_view_t(encoded.data(), encoded.size()),
+        [&](const spdlog::details::log_msg &msg) {
+            REQUIRE(msg.fields == plain.fields);
+            json.format(msg, decoded);
+        });
+    REQUIRE(decoded.size() > 0);
+}
+
+namespace {
+// constructed before main(), so destroyed after the field key table would be if it were a plain static.
+// its destructor formats interned keys on an async worker, as the registry's thread pool does at exit.
+struct log_at_exit
+{
+    std::ostringstream oss;
+    std::shared_ptr<spdlog::details::thread_pool> tp;
+    std::shared_ptr<spdlog::async_logger> logger;
+    const spdlog::field_key *key = nullptr;
+
+    ~log_at_exit()
+    {
+        if (logger)
+        {
+            for (int i = 0; i < 8; i++)
+            {
+                logger->info("bye").field(*key, i);
+            }
+            logger.reset();
+            tp.reset();
+        }
+    }
+} s_log_at_exit;
+} // namespace
+
+TEST_CASE("interned field keys can be logged at exit", "[json_formatter]")
+{
+    static const spdlog::field_key key("logged_at_exit");
+    auto oss_sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(s_log_at_exit.oss);
+    oss_sink->set_populators(spdlog::details::make_unique<spdlog::populators::message_populator>());
+    s_log_at_exit.tp = std::make_shared<spdlog::details::thread_pool>(16, 1);
+    s_log_at_exit.logger = std::make_shared<spdlog::async_logger>("at_exit", oss_sink, s_log_at_exit.tp);
+    s_log_at_exit.key = &key;
+    REQUIRE(key.rendered() == spdlog::string_view_t(R"("logged_at_exit":)"));
+}
+
+TEST_CASE("executor is a small handle to a pooled context", "[json_formatter]")
+{
+    REQUIRE(sizeof(spdlog::details::executor) == sizeof(void *));
+
+    std::ostringstream oss;
+    auto oss_sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(oss);
+    auto oss_logger = std::make_shared<spdlog::logger>("oss", oss_sink);
+    oss_logger->set_populators(spdlog::details::make_unique<spdlog::populators::message_populator>());
+    auto eol = std::string(spdlog::details::os::default_eol);
+
+    // nested entries on the same thread use separate contexts, reused contexts start empty
+    {
+        auto outer = oss_logger->info("outer");
+        outer({{"a", 1}}).field("b", 2);
+        oss_logger->info("inner")({{"c", 3}});
+    }
+    oss_logger->info("reused");
+    REQUIRE(oss.str() == R"({"message":"inner","c":3})" + eol + R"({"message":"outer","a":1,"b":2})" + eol + R"({"message":"reused"})" + eol);
+
+    // an entry may be finished on another thread
+    oss.str("");
+    auto moved = oss_logger->info("moved");
+    moved.field("n", 1);
+    std::thread([&moved] { spdlog::details::executor finished(std::move(moved)); }).join();
+    oss_logger->info("after");
+    REQUIRE(oss.str() == R"({"message":"moved","n":1})" + eol + R"({"message":"after"})" + eol);
+}
+
+namespace {
+struct log_on_thread_exit
+{
+    spdlog::logger *lgr = nullptr;
+
+    ~log_on_thread_exit()
+    {
+        lgr->info("exit").field("n", 1);
+    }
+};
+} // namespace
+
+TEST_CASE("entries can be logged after the thread's context pool is destroyed", "[json_formatter]")
+{
+    std::ostringstream oss;
+    auto oss_sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(oss);
+    spdlog::logger oss_logger("oss", oss_sink);
+    oss_logger.set_populators(spdlog::details::make_unique<spdlog::populators::message_populator>());
+
+    // constructed before the pool of the thread, so destroyed after it
+    std::thread([&oss_logger] {
+        thread_local log_on_thread_exit on_exit;
+        on_exit.lgr = &oss_logger;
+        oss_logger.info("running");
+    }).join();
+    auto eol = std::string(spdlog::details::os::default_eol);
+    REQUIRE(oss.str() == R"({"message":"running"})" + eol + R"({"message":"exit","n":1})" + eol);
+}
+
+TEST_CASE("formatted payloads are written into the executor buffer", "[json_formatter]")
+{
+    std::ostringstream oss;
+    auto oss_sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(oss);
+    auto oss_logger = std::make_shared<spdlog::logger>("oss", oss_sink);
+    oss_logger->set_populators(spdlog::details::make_unique<spdlog::populators::message_populator>());
+    auto eol = std::string(spdlog::details::os::default_eol);
+
+    // larger than the inline storage of the buffer, followed by fields and params
+    const std::string text(1000, 'x');
+    oss_logger->info("{}-{}", text, 42)({{"a", 1}}).field("b", 2);
+    REQUIRE(oss.str() == R"({"message":")" + text + R"(-42","a":1,"b":2})" + eol);
+
+    // a format error does not log a partial entry, nor leave it to the next one
+    oss.str("");
+    std::string err;
+    oss_logger->set_error_handler([&err](const std::string &msg) { err = msg; });
+    oss_logger->info(fmt::runtime("bad {} {}"), "format");
+    oss_logger->info("after {}", 1);
+    REQUIRE_FALSE(err.empty());
+    REQUIRE(oss.str() == R"({"message":"after 1"})" + eol);
+}
@@ -275,3 +275,52 @@ TEST_CASE("default logger API", "[default logger]")
     spdlog::drop_all();
     spdlog::set_pattern("%v");
 }
+
+TEST_CASE("latency histogram", "[metrics]")
+{
+    using spdlog::details::latency_histogram;
+    latency_histogram histogram;
+    REQUIRE(histogram.count() == 0);
+    REQUIRE(histogram.percentile(0.5) == 0);
+
+    // small values are exact, larger ones within 1/16 of their value
+    for (uint64_t v : {0ull, 1ull, 15ull, 16ull, 17ull, 1000ull, 123456ull, 1ull << 30})
+    {
+        auto upper = latency_histogram::upper_bound_of(latency_histogram::bucket_of(v));
+        REQUIRE(upper >= v);
+        REQUIRE(upper - v <= v / 16);
+    }
+    REQUIRE(latency_histogram::bucket_of(~0ull) == latency_histogram::bucket_count - 1);
+
+    for (uint64_t v = 1; v <= 1000; v++)
+    {
+        histogram.record(std::chrono::microseconds(v));
+    }
+    REQUIRE(histogram.count() == 1000);
+    auto p50 = histogram.percentile(0.5);
+    auto p99 = histogram.percentile(0.99);
+    REQUIRE(p50 >= 500000);
+    REQUIRE(p50 <= 500000 + 500000 / 16);
+    REQUIRE(p99 >= 990000);
+    REQUIRE(p99 <= 990000 + 990000 / 16);
+    REQUIRE(histogram.percentile(1.0) >= 1000000);
+}
+
+TEST_CASE("sink metrics", "[metrics]")
+{
+    std::ostringstream oss;
+    auto oss_sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(oss);
+    spdlog::logger oss_logger("oss", oss_sink);
+    oss_logger.set_pattern("%v");
+
+    oss_logger.info("Hello");
+    oss_logger.info("Hello again {}", 2);
+    oss_logger.flush();
+
+    auto &metrics = oss_sink->metrics();
+    REQUIRE(metrics.messages.load() == 2);
+    REQUIRE(metrics.bytes.load() == oss.str().size());
+    REQUIRE(metrics.flushes.load() == 1);
+    REQUIRE(metrics.write_latency.count() == (2 + SPDLOG_SINK_LATENCY_SAMPLE_RATE - 1) / SPDLOG_SINK_LATENCY_SAMPLE_RATE);
+    REQUIRE(metrics.flush_latency.count() == 1);
+}
@@ -0,0 +1,121 @@
+/*
+ * This content is released under the MIT License as specified in https://raw.githubusercontent.com/gabime/spdlog/master/LICENSE
+ */
+#include "includes.h"
+#include "spdlog/sinks/mmap_file_sink.h"
+
+#define MMAP_LOG "test_logs/mmap_log.txt"
+
+TEST_CASE("mmap_file_logger", "[mmap_logger]")
+{
+    prepare_logdir();
+    spdlog::sinks::mmap_file_sink_config config(SPDLOG_FILENAME_T(MMAP_LOG));
+    config.segment_size = 4096;
+    {
+        auto logger = spdlog::mmap_logger_mt("mmap_logger", config);
+        logger->set_pattern("%v");
+        logger->info("Test message {}", 1);
+        logger->info("Test message {}", 2);
+        logger->flush();
+
+        // the segment is preallocated, and the messages are already in the file
+        REQUIRE(get_filesize(MMAP_LOG) >= config.segment_size);
+        using spdlog::details::os::default_eol;
+        REQUIRE(file_contents(MMAP_LOG).find(fmt::format("Test message 1{}Test message 2{}", default_eol, default_eol)) == 0);
+        spdlog::drop("mmap_logger");
+    }
+
+    // the file was truncated to its messages once closed
+    require_message_count(MMAP_LOG, 2);
+}
+
+TEST_CASE("mmap_file_logger across segments", "[mmap_logger]")
+{
+    prepare_logdir();
+    spdlog::sinks::mmap_file_sink_config config(SPDLOG_FILENAME_T(MMAP_LOG));
+    config.segment_size = 4096;
+    size_t messages = 1000;
+    std::string expected;
+    {
+        auto sink = std::make_shared<spdlog::sinks::mmap_file_sink_st>(config);
+        spdlog::logger logger("mmap_logger", sink);
+        logger.set_pattern("%v");
+        for (size_t i = 0; i < messages; i++)
+        {
+            logger.info("Test message {}", i);
+            expected += fmt::format("Test message {}{}", i, spdlog::details::os::default_eol);
+        }
+        REQUIRE(sink->size() == expected.size());
+        REQUIRE(sink->metrics().bytes.load() == expected.size());
+    }
+    REQUIRE(file_contents(MMAP_LOG) == expected);
+}
+
+TEST_CASE("mmap_file_logger recovers preallocated space", "[mmap_logger]")
+{
+    prepare_logdir();
+    // what a crash leaves behind: the data, which may end with zero bytes (e.g. binary records),
+    // zeros up to the end of the segment, and the size file holding the written size
+    std::string crashed = std::string("Test message 1\n") + std::string(4, '\0');
+    spdlog::details::os::create_dir(SPDLOG_FILENAME_T("test_logs"));
+    {
+        std::ofstream ofs(MMAP_LOG, std::ios::binary);
+        ofs << crashed << std::string(4096 - crashed.size(), '\0');
+        std::ofstream size_file(MMAP_LOG ".size", std::ios::binary);
+        uint64_t size = crashed.size();
+        size_file.write(reinterpret_cast<const char *>(&size), sizeof(size));
+    }
+
+    spdlog::sinks::mmap_file_sink_config config(SPDLOG_FILENAME_T(MMAP_LOG));
+    config.segment_size = 4096;
+    {
+        auto sink = std::make_shared<spdlog::sinks::mmap_file_sink_st>(config);
+        spdlog::logger logger("mmap_logger", sink);
+        logger.set_pattern("%v");
+        logger.info("Test message 2");
+    }
+    REQUIRE(file_contents(MMAP_LOG) == crashed + "Test message 2" + spdlog::details::os::default_eol);
+    REQUIRE_FALSE(spdlog::details::os::path_exists(SPDLOG_FILENAME_T(MMAP_LOG ".size")));
+}
+
+TEST_CASE("mmap_file_logger keeps trailing zero bytes", "[mmap_logger]")
+{
+    prepare_logdir();
+    spdlog::sinks::mmap_file_sink_config config(SPDLOG_FILENAME_T(MMAP_LOG));
+    config.segment_size = 4096;
+    // a whole segment of data ending with zero bytes, closed, then reopened
+    std::string data = std::string(4096 - 4, 'x') + std::string(4, '\0');
+    {
+        spdlog::details::mmap_file file;
+        file.open(config.filename, false, config.segment_size);
+        file.write(data.data(), data.size());
+    }
+    {
+        spdlog::details::mmap_file file;
+        file.open(config.filename, false, config.segment_size);
+        REQUIRE(file.size() == data.size());
+        file.write("end", 3);
+    }
+    REQUIRE(file_contents(MMAP_LOG) == data + "end");
+}
+
+TEST_CASE("mmap_file_logger rotation", "[mmap_logger]")
+{
+    prepare_logdir();
+    spdlog::sinks::mmap_file_sink_config config(SPDLOG_FILENAME_T(MMAP_LOG));
+    config.segment_size = 4096;
+    config.max_size = 1024;
+    config.max_files = 2;
+    {
+        auto sink = std::make_shared<spdlog::sinks::mmap_file_sink_st>(config);
+        spdlog::logger logger("mmap_logger", sink);
+        for (int i = 0; i < 100; i++)
+        {
+            logger.info("Test message {}", i);
+        }
+    }
+    REQUIRE(get_filesize(MMAP_LOG) <= config.max_size);
+    REQUIRE(get_filesize("test_logs/mmap_log.1.txt") <= config.max_size);
+    REQUIRE(get_filesize("test_logs/mmap_log.2.txt") <= config.max_size);
+    REQUIRE(count_files("test_logs") == 3);
+}
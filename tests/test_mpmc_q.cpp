@@ -104,3 +104,39 @@ TEST_CASE("full_queue", "[mpmc_blocking_q]")
     q.dequeue_for(item, milliseconds(0));
     REQUIRE(item == 123456);
 }
+
+TEST_CASE("wait_strategies", "[mpmc_blocking_q]")
+{
+    using spdlog::async_wait_strategy;
+    for (auto strategy : {async_wait_strategy::block, async_wait_strategy::spin_yield, async_wait_strategy::busy_spin})
+    {
+        INFO("Strategy " << static_cast<int>(strategy));
+        std::unique_ptr<spdlog::details::async_queue<int>> queues[] = {
+            spdlog::details::make_unique<spdlog::details::mpmc_blocking_queue<int>>(16, strategy),
+            spdlog::details::make_unique<spdlog::details::mpmc_lockfree_queue<int>>(16, strategy)};
+        for (auto &q : queues)
+        {
+            // the timeout is honored while spinning too
+            int item = -1;
+            auto start = test_clock::now();
+            REQUIRE_FALSE(q->dequeue_for(item, milliseconds(50)));
+            REQUIRE(millis_from(start) >= milliseconds(50));
+
+            // a producer blocked on the small queue and a waiting consumer hand over every item, in order
+            const int items = 1000;
+            std::thread producer([&q, items] {
+                for (int i = 0; i < items; i++)
+                {
+                    q->enqueue(i + 0);
+                }
+            });
+            for (int i = 0; i < items; i++)
+            {
+                REQUIRE(q->dequeue_for(item, milliseconds(1000)));
+                REQUIRE(item == i);
+            }
+            producer.join();
+            REQUIRE(q->overrun_counter() == 0);
+        }
+    }
+}